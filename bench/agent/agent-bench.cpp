@@ -0,0 +1,129 @@
+#include "agent/agent-bench.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "agent/agent-manager.h"
+#include "bench-maps.h"
+
+using Rally::AgentManager;
+using Rally::AgentWrapper;
+using Rally::RaceResult;
+using Rally::RallyMap;
+using RallyBench::benchMap;
+
+namespace RallyBench {
+
+namespace {
+
+// Agents that learn and preprocess the whole map the first time they race on
+// a terrain, and only run cheap queries on it after that. Every bench map is
+// its own terrain, so timing them like the other agents would mix one
+// expensive first race with many cheap ones and measure neither.
+const char* const kPreprocessingAgents[] = {
+    "HPAStar", "CH", "AStarOptALT", "NBAStarOptALT", "DStarLite"};
+
+bool preprocesses(const char* name) {
+  for(const auto& preprocessing : kPreprocessingAgents) {
+    if(std::strcmp(name, preprocessing) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void addArgs(benchmark::internal::Benchmark* bench,
+             const std::vector<int64_t>& sizes) {
+  bench->ArgNames({"size", "distance"})->Unit(benchmark::kMicrosecond);
+
+  for(const auto& size : sizes) {
+    for(const auto& distance : benchDistances(size)) {
+      bench->Args({size, distance});
+    }
+  }
+}
+
+}  // namespace
+
+// Registers a benchmark for every registered agent. Agents are registered
+// when the program starts, so their benchmarks can't be registered
+// statically like the others.
+//
+// Agents that preprocess the whole map get two benchmarks on smaller maps.
+// `BM_RunAgent` times races once the map has been preprocessed, and
+// `BM_PrepareAgent` times the first race of a new agent on the map, which
+// includes learning and preprocessing it.
+void registerAgentBenchmarks() {
+  // The wrappers have to outlive the benchmarks, which only run after this
+  // returns.
+  static std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  for(size_t i = 0; i < wrappers.size(); ++i) {
+    AgentWrapper* const agent = &wrappers[i];
+    const bool preprocessing = preprocesses(agent->getName());
+    const std::string name = std::string("BM_RunAgent/") + agent->getName();
+
+    auto run = [agent, preprocessing](benchmark::State& state) {
+      const RallyMap& map = benchMap(state.range(0), state.range(1));
+      RaceResult result{};
+
+      // The map is preprocessed before timing starts.
+      if(preprocessing) {
+        agent->runRace(map);
+      }
+
+      for(auto _ : state) {
+        result = agent->runRace(map);
+        benchmark::DoNotOptimize(result.path.data());
+      }
+
+      state.counters["map_looks"] = result.mapLooks;
+      state.counters["path_cost"] = result.pathCost;
+    };
+
+    addArgs(benchmark::RegisterBenchmark(name.c_str(), run),
+            preprocessing ? kPreprocessSizes : kMapSizes);
+
+    if(!preprocessing) {
+      continue;
+    }
+
+    const std::string prepareName =
+        std::string("BM_PrepareAgent/") + agent->getName();
+
+    auto prepare = [i](benchmark::State& state) {
+      const RallyMap& map = benchMap(state.range(0), state.range(1));
+      RaceResult result{};
+
+      // Every race is run by a new instance of the agent, so none of them
+      // can reuse what an earlier one learned.
+      std::vector<AgentWrapper> fresh;
+      for(auto _ : state) {
+        state.PauseTiming();
+        fresh.clear();
+        AgentManager::GetInstance()->makeAgents(fresh);
+        state.ResumeTiming();
+
+        result = fresh[i].runRace(map);
+        benchmark::DoNotOptimize(result.path.data());
+      }
+
+      state.counters["map_looks"] = result.mapLooks;
+      state.counters["path_cost"] = result.pathCost;
+    };
+
+    // Like `BM_BuildHierarchy`, one race is enough on maps this slow to
+    // preprocess.
+    benchmark::internal::Benchmark* const prepareBench =
+        benchmark::RegisterBenchmark(prepareName.c_str(), prepare);
+    addArgs(prepareBench, kPreprocessSizes);
+    prepareBench->Unit(benchmark::kMillisecond)->Iterations(1);
+  }
+}
+
+}  // namespace RallyBench
@@ -0,0 +1,13 @@
+#ifndef BENCH_AGENT_AGENT_BENCH_H_
+#define BENCH_AGENT_AGENT_BENCH_H_
+
+namespace RallyBench {
+
+// Registers a benchmark for every registered agent. Agents are registered
+// when the program starts, so their benchmarks can't be registered
+// statically like the others.
+void registerAgentBenchmarks();
+
+}  // namespace RallyBench
+
+#endif /* BENCH_AGENT_AGENT_BENCH_H_ */
@@ -0,0 +1,60 @@
+#ifndef BENCH_BENCH_MAPS_H_
+#define BENCH_BENCH_MAPS_H_
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "map/rally-map.h"
+#include "map/random.h"
+
+namespace RallyBench {
+
+// The map sizes every benchmark is run on.
+const std::vector<int64_t> kMapSizes = {8, 64, 512, 4096};
+
+// The map sizes for benchmarks that learn and preprocess the whole map first.
+// Preprocessing the largest bench map takes too long to be worth measuring.
+const std::vector<int64_t> kPreprocessSizes = {64, 512, 2048};
+
+// The seed every benchmark map is made from, so runs can be compared.
+constexpr uint64_t kMapSeed = 0x5EED;
+
+// A square map with the start and finish `distance` hexes apart along the
+// middle row. Maps are made once and shared, since the large ones are slow to
+// make.
+inline const Rally::RallyMap& benchMap(uint size, uint distance) {
+  static std::map<std::pair<uint, uint>, std::unique_ptr<Rally::RallyMap>>
+      maps;
+
+  std::unique_ptr<Rally::RallyMap>& map = maps[{size, distance}];
+  if(!map) {
+    Rally::Random random(Rally::Random::deriveSeed(kMapSeed, size));
+    map.reset(new Rally::RallyMap(size, size, random));
+
+    const int middle = size / 2;
+    map->setEndPoints({0, middle}, {static_cast<int>(distance), middle});
+  }
+
+  return *map;
+}
+
+// The start and finish distances worth measuring on a map of the given size:
+// close together, halfway across, and all the way across.
+inline std::vector<int64_t> benchDistances(int64_t size) {
+  std::vector<int64_t> distances;
+
+  for(const int64_t distance : {int64_t(4), size / 2, size - 1}) {
+    if(distance > 0 && distance < size &&
+       (distances.empty() || distances.back() < distance)) {
+      distances.push_back(distance);
+    }
+  }
+
+  return distances;
+}
+
+}  // namespace RallyBench
+
+#endif /* BENCH_BENCH_MAPS_H_ */
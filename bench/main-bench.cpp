@@ -0,0 +1,16 @@
+#include <benchmark/benchmark.h>
+
+#include "agent/agent-bench.h"
+
+int main(int argc, char* argv[]) {
+  RallyBench::registerAgentBenchmarks();
+
+  ::benchmark::Initialize(&argc, argv);
+  if(::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  ::benchmark::RunSpecifiedBenchmarks();
+  ::benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include "bench-maps.h"
+#include "map/random.h"
+#include "map/rally-map.h"
+
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+using RallyBench::benchMap;
+
+namespace {
+
+// Enough random moves that the benchmark isn't measuring one hot cache line,
+// while staying small enough that generating them doesn't matter.
+constexpr size_t kNumMoves = 4096;
+
+struct Move {
+  Point pos;
+  Direction::T dir;
+};
+
+std::vector<Move> randomMoves(const RallyMap& map) {
+  Random random(RallyBench::kMapSeed);
+  std::vector<Move> moves(kNumMoves);
+
+  for(auto& move : moves) {
+    move.pos = {static_cast<int>(random.below(map.getWidth())),
+                static_cast<int>(random.below(map.getHeight()))};
+    move.dir = Direction::kAllMoveDirections[random.below(6)];
+  }
+
+  return moves;
+}
+
+void sizeArgs(benchmark::internal::Benchmark* bench) {
+  for(const auto& size : RallyBench::kMapSizes) {
+    bench->Arg(size);
+  }
+}
+
+void BM_GetMoveCost(benchmark::State& state) {
+  const RallyMap& map = benchMap(state.range(0), 1);
+  const std::vector<Move> moves = randomMoves(map);
+  size_t i = 0;
+
+  for(auto _ : state) {
+    const Move& move = moves[i++ % kNumMoves];
+    benchmark::DoNotOptimize(map.getMoveCost(move.pos, move.dir));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetMoveCost)->Apply(sizeArgs);
+
+void BM_GetDestination(benchmark::State& state) {
+  const RallyMap& map = benchMap(state.range(0), 1);
+  const std::vector<Move> moves = randomMoves(map);
+  size_t i = 0;
+
+  for(auto _ : state) {
+    const Move& move = moves[i++ % kNumMoves];
+    benchmark::DoNotOptimize(map.getDestination(move.pos, move.dir));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetDestination)->Apply(sizeArgs);
+
+void BM_GetNeighbors(benchmark::State& state) {
+  const RallyMap& map = benchMap(state.range(0), 1);
+  const std::vector<Move> moves = randomMoves(map);
+  size_t i = 0;
+
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(map.getNeighbors(moves[i++ % kNumMoves].pos));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetNeighbors)->Apply(sizeArgs);
+
+// The path is a straight run of north east moves along the middle row, one
+// per column, from the start on the left edge to the finish on the right.
+void BM_AnalyzePath(benchmark::State& state) {
+  const uint size = state.range(0);
+  const RallyMap& map = benchMap(size, size - 1);
+
+  std::vector<Direction::T> path;
+  for(uint i = 0; i + 1 < size; ++i) {
+    path.push_back(Direction::T::eNorthEast);
+  }
+
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(map.analyzePath(path));
+  }
+
+  state.SetItemsProcessed(state.iterations() * path.size());
+}
+BENCHMARK(BM_AnalyzePath)->Apply(sizeArgs);
+
+void BM_ToString(benchmark::State& state) {
+  const uint size = state.range(0);
+  const RallyMap& map = benchMap(size, 1);
+
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(map.toString());
+  }
+
+  state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(BM_ToString)->Apply(sizeArgs)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "bench-maps.h"
+#include "map/map-interface.h"
+#include "map/random.h"
+#include "search/arena.h"
+#include "search/contraction-hierarchy.h"
+#include "search/terrain-cache.h"
+
+using Rally::Arena;
+using Rally::ContractionHierarchy;
+using Rally::HierarchyQuery;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+using Rally::TerrainCache;
+using RallyBench::benchMap;
+
+namespace {
+
+// Enough random queries that the benchmark isn't measuring one path.
+constexpr size_t kNumQueries = 1024;
+
+void sizeArgs(benchmark::internal::Benchmark* bench) {
+  for(const auto& size : RallyBench::kPreprocessSizes) {
+    bench->Arg(size);
+  }
+}
+
+TerrainCache learnTerrain(const RallyMap& map) {
+  Arena arena;
+  MapInterface api(map, arena);
+  TerrainCache terrain;
+  std::vector<Point> changed;
+  terrain.update(&api, changed);
+  return terrain;
+}
+
+void BM_BuildHierarchy(benchmark::State& state) {
+  const TerrainCache terrain = learnTerrain(benchMap(state.range(0), 1));
+  ContractionHierarchy hierarchy;
+
+  for(auto _ : state) {
+    hierarchy.build(terrain);
+  }
+
+  state.counters["edges"] = hierarchy.getNumEdges();
+}
+BENCHMARK(BM_BuildHierarchy)
+    ->Apply(sizeArgs)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(1);
+
+void BM_HierarchyQuery(benchmark::State& state) {
+  const int size = state.range(0);
+  const TerrainCache terrain = learnTerrain(benchMap(size, 1));
+  ContractionHierarchy hierarchy;
+  hierarchy.build(terrain);
+
+  Random random(RallyBench::kMapSeed);
+  std::vector<std::pair<Point, Point>> queries(kNumQueries);
+  for(auto& query : queries) {
+    query.first = {static_cast<int>(random.below(size)),
+                   static_cast<int>(random.below(size))};
+    query.second = {static_cast<int>(random.below(size)),
+                    static_cast<int>(random.below(size))};
+  }
+
+  HierarchyQuery query;
+  size_t i = 0;
+  for(auto _ : state) {
+    const auto& ends = queries[i++ % kNumQueries];
+    benchmark::DoNotOptimize(
+        query.findPath(hierarchy, ends.first, ends.second).data());
+  }
+}
+BENCHMARK(BM_HierarchyQuery)
+    ->Apply(sizeArgs)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
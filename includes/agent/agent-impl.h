@@ -9,6 +9,15 @@
 
 #define MAKE_AGENT_NAME(name) Agent_##name
 
+namespace Rally {
+
+// The scratch memory of agents that don't keep any between races.
+struct NoScratch {
+  void reset() {}
+};
+
+}  // namespace Rally
+
 // This macro is what automatically registers an agent.
 //
 // This works by using the code following the macro as the definition of the
@@ -19,16 +28,26 @@
 // The `(MapInterface* const api)` part of `RunAgent` is left exposed so
 // the availability of the `MapInterface` is obvious, and so that it may be
 // named as desired.
-#define REGISTER_AGENT(agentName)                                      \
+#define REGISTER_AGENT(agentName) \
+  REGISTER_AGENT_WITH_SCRATCH(agentName, Rally::NoScratch)
+
+// Registers an agent that keeps an instance of `ScratchType` between races.
+// `RunAgent` can use it as `scratch`, and `scratch.reset()` is called before
+// every race. Each agent instance is only ever used by one thread at a time, so
+// the scratch needs no locking.
+#define REGISTER_AGENT_WITH_SCRATCH(agentName, ScratchType)            \
   class MAKE_AGENT_NAME(agentName) : public Rally::AgentBase {         \
     static std::shared_ptr<Rally::AgentFactoryBase> const factory;     \
     const char* name = #agentName;                                     \
+    ScratchType scratch;                                               \
                                                                        \
    public:                                                             \
     const char* getName() const { return name; }                       \
                                                                        \
     MAKE_AGENT_NAME(agentName)() {}                                    \
                                                                        \
+    virtual void reset() { scratch.reset(); }                          \
+                                                                       \
     virtual std::vector<Direction::T> RunAgent(                        \
         Rally::MapInterface* const api);                               \
   };                                                                   \
@@ -25,6 +25,9 @@ class AgentManager {
   std::shared_ptr<AgentFactoryBase> registerAgent(
       std::shared_ptr<AgentFactoryBase> fact);
 
+  // The number of agents that have been registered.
+  size_t getNumAgents() const;
+
   // Creates an vector with a single instance of each agent in a wrapper.
   void makeAgents(std::vector<AgentWrapper>& agents) const;
 };
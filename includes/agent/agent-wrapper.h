@@ -1,17 +1,44 @@
 #ifndef AGENT_AGENT_WRAPPER_H_
 #define AGENT_AGENT_WRAPPER_H_
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "agent/rally-agent.h"
 #include "map/hex-direction.h"
+#include "search/arena.h"
+#include "stats/latency-histogram.h"
 
 namespace Rally {
 
+// The outcome of running one agent on one race.
+struct RaceResult {
+  std::vector<Direction::T> path;
+  uint mapLooks;
+  uint expansions;
+  uint pathCost;
+  bool finishedRace;
+  // Time spent in `RunAgent`, in nanoseconds.
+  uint64_t wallNanos;
+  uint64_t cpuNanos;
+  // The most heap memory `RunAgent` had allocated at once, in bytes.
+  int64_t peakHeapBytes;
+  // The number of heap allocations `RunAgent` made, and their total size.
+  uint64_t allocations;
+  uint64_t allocatedBytes;
+  // How many times the cheapest path the agent said its path costs at most,
+  // or zero if it didn't say. See `MapInterface::reportBound`.
+  double bound;
+};
+
 // AgentWrapper collects statistics on Agent implementations, and manages
 // interactions with the agent.
 class AgentWrapper {
   std::unique_ptr<AgentBase> agent;
+  // Released in one go at the end of every race.
+  Arena arena;
+  SearchBudget budget;
 
  public:
   // Single race statistics.
@@ -19,16 +46,39 @@ class AgentWrapper {
   uint mapLooks;
   uint pathCost;
   bool finishedRace;
+  uint64_t wallNanos;
+  uint64_t cpuNanos;
+  uint64_t allocations;
+  uint64_t allocatedBytes;
+  int64_t peakHeapBytes;
+  double bound;
 
   // Overall statistics.
   uint totalMapLooks;
   uint totalPathCost;
   uint racesFinished;
+  uint64_t totalCpuNanos;
+  uint64_t totalAllocations;
+  uint64_t totalAllocatedBytes;
+  // The largest peak of any one race.
+  int64_t maxPeakHeapBytes;
+  // The wall clock time of every race.
+  LatencyHistogram latency;
 
   const char* getName() const;
 
   explicit AgentWrapper(std::unique_ptr<AgentBase> agent);
 
+  // The budget every race after this is run with. See `SearchBudget`.
+  void setBudget(const SearchBudget& nBudget);
+
+  // Runs the agent on the race without recording any statistics. Races can
+  // be run by a different wrapper than the one that records them.
+  RaceResult runRace(const RallyMap& rally);
+  // Records the result of a race in both the single race and the overall
+  // statistics.
+  void recordRace(RaceResult result);
+  // Runs the agent on the race and records the result.
   void addRace(const RallyMap& rally);
 
   // This can be passed to functions like `std::sort` to sort agents by how
@@ -14,6 +14,11 @@ class AgentBase {
   // This is the function called to run the Agent on a RallyMap
   virtual std::vector<Direction::T> RunAgent(MapInterface* const api) = 0;
 
+  // Called before every race. An agent can keep scratch memory between races
+  // so it doesn't pay for allocating it again, and forget the last race here
+  // while keeping that memory reserved.
+  virtual void reset() {}
+
   virtual ~AgentBase() {}
 };
 
@@ -0,0 +1,39 @@
+#ifndef DRIVER_MAP_CORPUS_H_
+#define DRIVER_MAP_CORPUS_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "map/map-file.h"
+#include "map/rally-map.h"
+
+namespace Rally {
+
+// A fixed list of maps to race on, so that runs can be compared with each
+// other. A corpus is either a map archive, or a directory of map files. In a
+// directory ".rallymap" files are binary map files and ".txt" files are text
+// maps, and they're raced in order of their names. Anything else in the
+// directory is skipped.
+//
+// Binary maps are raced with the encoding and layout they were saved with, so
+// they never have to be copied. Text maps are converted to the given ones.
+class MapCorpus {
+  std::unique_ptr<MapArchive> archive;
+  std::vector<std::string> files;
+  Encoding encoding;
+  Layout layout;
+
+ public:
+  // Throws an exception if the corpus can't be read, or holds no maps.
+  MapCorpus(const std::string& path, Encoding encoding, Layout layout);
+
+  size_t size() const;
+
+  // Throws an exception if the map can't be read or isn't valid.
+  RallyMap load(size_t i) const;
+};
+
+}  // namespace Rally
+
+#endif /* DRIVER_MAP_CORPUS_H_ */
@@ -0,0 +1,58 @@
+#ifndef DRIVER_MAP_PREFETCHER_H_
+#define DRIVER_MAP_PREFETCHER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "map/rally-map.h"
+
+namespace Rally {
+
+// Loads maps in order on a background thread, so the next maps are ready by
+// the time the races on the current ones are done. At most `depth` maps are
+// kept waiting, which bounds the memory used by maps that haven't been raced
+// yet.
+class MapPrefetcher {
+  const std::function<RallyMap(size_t)> load;
+  const size_t count;
+  const size_t depth;
+
+  std::mutex mutex;
+  std::condition_variable loaded;
+  std::condition_variable taken;
+
+  // Guarded by `mutex`.
+  std::deque<RallyMap> ready;
+  size_t numLoaded;
+  // Set if loading a map threw. It's thrown again in place of that map.
+  std::exception_ptr error;
+  bool stopping;
+
+  std::thread loader;
+
+  void work();
+
+ public:
+  // Starts loading maps `0` through `count - 1` with `load`.
+  MapPrefetcher(size_t count,
+                size_t depth,
+                std::function<RallyMap(size_t)> load);
+  ~MapPrefetcher();
+
+  MapPrefetcher(const MapPrefetcher&) = delete;
+  MapPrefetcher& operator=(const MapPrefetcher&) = delete;
+
+  // Waits for the next map and appends it to `maps`. Returns false once every
+  // map has been taken. If loading the map threw an exception, it's thrown
+  // again here.
+  bool next(std::vector<RallyMap>& maps);
+};
+
+}  // namespace Rally
+
+#endif /* DRIVER_MAP_PREFETCHER_H_ */
@@ -0,0 +1,64 @@
+#ifndef DRIVER_RACE_POOL_H_
+#define DRIVER_RACE_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "agent/agent-wrapper.h"
+#include "map/rally-map.h"
+
+namespace Rally {
+
+// A pool of worker threads that run races. Each worker makes its own instance
+// of every agent, so agents never share state across threads. A batch of races
+// is split into one task per agent per race, and the tasks are handed out to
+// whichever worker is free.
+//
+// The results are returned in race order and agent registration order, so
+// they can be recorded exactly as if the races were run one after another.
+class RacePool {
+  std::vector<std::thread> workers;
+  const size_t numAgents;
+  // Every worker's agents race with this budget.
+  const SearchBudget budget;
+
+  std::mutex mutex;
+  std::condition_variable batchReady;
+  std::condition_variable batchDone;
+
+  // The batch being run. Only changed while every worker is waiting.
+  const std::vector<RallyMap>* maps;
+  std::vector<std::vector<RaceResult>>* results;
+  size_t numTasks;
+  std::atomic<size_t> nextTask;
+
+  // Guarded by `mutex`.
+  uint batch;
+  uint busyWorkers;
+  bool stopping;
+
+  void work();
+
+ public:
+  explicit RacePool(uint numThreads,
+                    const SearchBudget& budget = SearchBudget());
+  ~RacePool();
+
+  RacePool(const RacePool&) = delete;
+  RacePool& operator=(const RacePool&) = delete;
+
+  uint getNumThreads() const;
+
+  // Runs every agent on each of the maps, and blocks until they're all done.
+  // `results[race][agent]` is the result of the agent, in registration order,
+  // on `maps[race]`.
+  void runRaces(const std::vector<RallyMap>& maps,
+                std::vector<std::vector<RaceResult>>& results);
+};
+
+}  // namespace Rally
+
+#endif /* DRIVER_RACE_POOL_H_ */
@@ -0,0 +1,50 @@
+#ifndef DRIVER_RECORD_WRITER_H_
+#define DRIVER_RECORD_WRITER_H_
+
+#include <ostream>
+#include <string>
+
+#include "agent/agent-wrapper.h"
+#include "map/rally-map.h"
+
+namespace Rally {
+
+enum class RecordFormat {
+  eCsv,
+  // One JSON object per line.
+  eJsonLines,
+};
+
+// The name used on the command line, like "csv".
+const char* recordFormatName(RecordFormat format);
+
+// Streams one compact record per agent per race, for analysis tools to read.
+// Records are built up in a buffer and handed to the stream in large blocks,
+// so writing them costs far less than the races they describe. Anything still
+// buffered is written out when the writer is destroyed.
+class RecordWriter {
+  std::ostream& out;
+  const RecordFormat format;
+  std::string buffer;
+  bool wroteHeader;
+
+ public:
+  RecordWriter(std::ostream& out, RecordFormat format);
+  ~RecordWriter();
+
+  RecordWriter(const RecordWriter&) = delete;
+  RecordWriter& operator=(const RecordWriter&) = delete;
+
+  // `race` is the race number the map was made from.
+  void write(uint race,
+             const RallyMap& map,
+             const char* agentName,
+             const RaceResult& result);
+
+  // Hands everything buffered so far to the stream, and flushes it.
+  void flush();
+};
+
+}  // namespace Rally
+
+#endif /* DRIVER_RECORD_WRITER_H_ */
@@ -0,0 +1,29 @@
+#ifndef DRIVER_SIZE_SCHEDULE_H_
+#define DRIVER_SIZE_SCHEDULE_H_
+
+#include <string>
+#include <vector>
+
+namespace Rally {
+
+// The smallest and largest map sides a sweep can be run on. Larger maps would
+// overflow the per race counters, which are 32 bits.
+constexpr uint kMinSweepSize = 2;
+constexpr uint kMaxSweepSize = 16384;
+
+// Parses the map sizes a scaling sweep is run on. A schedule is one of:
+//
+//   linear:MIN:MAX:STEP      MIN, MIN + STEP, ... up to MAX.
+//   geometric:MIN:MAX:RATIO  MIN, MIN * RATIO, ... up to MAX. RATIO may be a
+//                            fraction, for example 1.5.
+//   list:A,B,C               Exactly the sizes given.
+//
+// MAX is always included even if the steps skip over it. The sizes are sorted
+// and duplicates removed, so memory use only grows as the sweep goes on.
+// Returns false if the schedule is malformed or a size is outside of
+// `kMinSweepSize` and `kMaxSweepSize`.
+bool parseSizeSchedule(const std::string& schedule, std::vector<uint>& sizes);
+
+}  // namespace Rally
+
+#endif /* DRIVER_SIZE_SCHEDULE_H_ */
@@ -19,6 +19,34 @@ constexpr std::array<T, 6> kAllMoveDirections{T::eNorth,     T::eNorthEast,
                                               T::eSouthEast, T::eSouth,
                                               T::eSouthWest, T::eNorthWest};
 
+// A short list of directions. Unused entries are left as `T::eNone`.
+struct DirectionList {
+  std::array<T, 6> dirs;
+  unsigned char size;
+};
+
+// All points other than the start have another point before them in the path.
+// There is never a lower cost for backtracking or turning sharply, so only the
+// directions that continue forwards are worth checking. Indexed by the
+// direction moved to reach the point, with `T::eNone` allowing every move.
+constexpr std::array<DirectionList, 7> kForwardDirections{{
+    {{{T::eNorthWest, T::eNorth, T::eNorthEast, T::eNone, T::eNone, T::eNone}},
+     3},  // eNorth
+    {{{T::eNorth, T::eNorthEast, T::eSouthEast, T::eNone, T::eNone, T::eNone}},
+     3},  // eNorthEast
+    {{{T::eNorthEast, T::eSouthEast, T::eSouth, T::eNone, T::eNone, T::eNone}},
+     3},  // eSouthEast
+    {{{T::eSouthEast, T::eSouth, T::eSouthWest, T::eNone, T::eNone, T::eNone}},
+     3},  // eSouth
+    {{{T::eSouth, T::eSouthWest, T::eNorthWest, T::eNone, T::eNone, T::eNone}},
+     3},  // eSouthWest
+    {{{T::eSouthWest, T::eNorthWest, T::eNorth, T::eNone, T::eNone, T::eNone}},
+     3},  // eNorthWest
+    {{{T::eNorth, T::eNorthEast, T::eSouthEast, T::eSouth, T::eSouthWest,
+       T::eNorthWest}},
+     6}  // eNone
+}};
+
 // Reverses the given `Direction`.
 // Ex. North -> South.
 T reverse(T dir);
@@ -0,0 +1,79 @@
+#ifndef MAP_MAP_FILE_H_
+#define MAP_MAP_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "map/rally-map.h"
+
+namespace Rally {
+
+// A binary map file holds one `RallyMap` exactly as it's laid out in memory,
+// so it can be loaded without copying or converting anything. Every number is
+// little endian.
+//
+//   Offset  Size  Field
+//        0     8  "RALLYMAP"
+//        8     4  Version, currently `kMapFileVersion`.
+//       12     1  `Encoding`, either byte (1) or nibble (2).
+//       13     1  `Layout`, either dense (0) or padded (1).
+//       14     2  Zero.
+//       16     4  Width.
+//       20     4  Height.
+//       24    16  Start x and y, then finish x and y, as signed numbers.
+//       40     8  The number of bytes of cells, `RallyMap::memoryFootprint`.
+//       48    16  Zero.
+//       64     -  The packed roughness cells.
+//
+// Wide maps are written with the byte encoding, which holds the same values
+// without depending on the byte order of the machine.
+//
+// Any number of map files can be joined end to end into an archive, so a
+// whole corpus of maps can be kept in one file.
+constexpr uint32_t kMapFileVersion = 1;
+constexpr size_t kMapFileHeaderSize = 64;
+
+class MappedFile;
+
+// A memory mapped archive of maps. Maps are only checked when they're loaded,
+// so opening even a large archive is quick.
+class MapArchive {
+  std::string path;
+  std::shared_ptr<const MappedFile> file;
+  // Where each map's header starts.
+  std::vector<size_t> offsets;
+
+ public:
+  // Throws an exception if the file can't be read, or isn't an archive.
+  explicit MapArchive(const std::string& path);
+
+  size_t size() const;
+
+  // Returns a map that reads its roughness straight from the archive. The
+  // archive stays mapped until every map loaded from it is changed or
+  // destroyed, even if the `MapArchive` itself is destroyed first.
+  //
+  // Throws an exception if the map isn't valid.
+  RallyMap load(size_t i) const;
+};
+
+// Appends a map file to the stream, which may already hold others.
+// Throws an exception if the stream can't be written to.
+void writeMapFile(std::ostream& out, const RallyMap& map);
+void writeMapFile(const std::string& path, const RallyMap& map);
+
+// Memory maps the file and returns a map that reads its roughness straight
+// from it. The file stays mapped until the map, and every copy of it, is
+// changed or destroyed. Where memory mapping isn't available the cells are
+// read into memory instead.
+//
+// Throws an exception if the file can't be read, or isn't a valid map file
+// holding exactly one map.
+RallyMap loadMapFile(const std::string& path);
+
+}  // namespace Rally
+
+#endif /* MAP_MAP_FILE_H_ */
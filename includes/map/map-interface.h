@@ -1,14 +1,41 @@
 #ifndef MAP_MAP_INTERFACE_H_
 #define MAP_MAP_INTERFACE_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "map/hex-direction.h"
 #include "map/rally-map.h"
 
 namespace Rally {
 
+class Arena;
+
+// How long an agent may search for a better path in one race. Zero means
+// there's no limit. Agents that don't improve on a path they already have
+// ignore the budget, so it only limits anytime agents like `ARAStar`.
+struct SearchBudget {
+  // Wall clock time since the race started, in nanoseconds.
+  uint64_t maxNanos = 0;
+  // Hexes expanded, as counted by `MapInterface::getExpansions`.
+  uint maxExpansions = 0;
+};
+
 class MapInterface {
   const RallyMap& map;
+  Arena& arena;
   uint mapLooks;
+  uint expansions;
+
+  SearchBudget budget;
+  uint64_t startNanos;
+  // The clock is only read every `kClockInterval` checks, and once the budget
+  // is spent it stays spent.
+  uint budgetChecks;
+  bool overBudget;
+  double bound;
+
+  static constexpr uint kClockInterval = 16;
 
  public:
   uint getHeight() const;
@@ -16,14 +43,47 @@ class MapInterface {
 
   Point getStart() const;
   Point getFinish() const;
+  // Races with the same terrain id have the same roughness everywhere, other
+  // than the start and finish. See `RallyMap::getTerrainId`.
+  uint64_t getTerrainId() const;
+  // Appends the hexes whose roughness was changed since the map had the given
+  // terrain id, if the map still knows. This doesn't count as a map look, as
+  // it doesn't say what the roughness is now. See `RallyMap::getEditsSince`.
+  bool getEditsSince(uint64_t terrainId, std::vector<Point>& edited) const;
 
   uint getMapLooks() const;
+  // The number of times neighbors were listed, which is how many hexes the
+  // agent expanded.
+  uint getExpansions() const;
+  // Counts hexes or nodes the agent expanded in a graph of its own, rather
+  // than by listing neighbors on the map.
+  void addExpansions(uint count);
+
+  MapInterface(const RallyMap& map,
+               Arena& arena,
+               const SearchBudget& budget = SearchBudget());
+
+  const SearchBudget& getBudget() const;
+  // Whether the agent has spent its budget, and should return the best path
+  // it has found so far.
+  bool isOverBudget();
+
+  // Lets an agent report that its path costs at most `nBound` times as much
+  // as the cheapest path. Zero means nothing was reported.
+  void reportBound(double nBound);
+  double getBound() const;
 
-  explicit MapInterface(const RallyMap& map);
+  // Memory for the agent's containers that only lasts for this race. See
+  // `ArenaVector` and the other containers in "search/arena.h".
+  Arena& getArena();
 
   // Creates a list of all the points surrounding the given one, and the
   // direction to that point.
-  std::vector<std::pair<Point, Direction::T>> getNeighbors(Point pos) const;
+  NeighborList getNeighbors(Point pos);
+  // Creates a list of the points surrounding the given one that are worth
+  // checking after arriving there by moving in `parentDir`. See
+  // `Direction::kForwardDirections`.
+  NeighborList getRelevantNeighbors(Point pos, Direction::T parentDir);
 
   // Determines the cost of moving in a given direction. If the move goes out
   // of bounds the agent returns to their starting position. This is not the
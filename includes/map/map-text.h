@@ -0,0 +1,47 @@
+#ifndef MAP_MAP_TEXT_H_
+#define MAP_MAP_TEXT_H_
+
+#include <istream>
+#include <string>
+
+#include "map/rally-map.h"
+
+namespace Rally {
+
+// Reads a map written as text, in either of two formats.
+//
+// The rhombus format is what `RallyMap::toString` writes. Each row is shifted
+// right by one more space than the row above it, and the hexes in a row are
+// separated by single spaces. The start is drawn as '*' and the finish as '&'.
+// The '|' markers above and below the map are optional, but have to line up
+// with the start and finish if they're there.
+//
+//    |
+//   8 1 3 5
+//    * 4 5 6
+//     3 8 9 4
+//      1 5 9 &
+//            |
+//
+// The compact format is one row per line with no spaces at all, like
+// "8135", "*456", "3894", and "159&" for the map above.
+//
+// The text is read in a single pass, one line at a time, straight into packed
+// cells, so very large maps never exist in any other form. Blank lines at the
+// end and '\r' line endings are ignored. The start and finish are given a
+// roughness of one, since they're always treated that way.
+//
+// Throws an exception naming the line at fault if the text isn't a valid
+// map.
+RallyMap parseMapText(std::istream& in,
+                      Encoding encoding = kDefaultEncoding,
+                      Layout layout = kDefaultLayout);
+
+// Throws an exception if the file can't be read, or isn't a valid map.
+RallyMap loadMapText(const std::string& path,
+                     Encoding encoding = kDefaultEncoding,
+                     Layout layout = kDefaultLayout);
+
+}  // namespace Rally
+
+#endif /* MAP_MAP_TEXT_H_ */
@@ -1,12 +1,20 @@
 #ifndef MAP_RALLY_MAP_H_
 #define MAP_RALLY_MAP_H_
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "map/hex-direction.h"
+#include "map/random.h"
 
 typedef unsigned int uint;
 
@@ -62,6 +70,171 @@ struct Point {
   inline bool operator>=(const Point& rhs) const { return !operator<(rhs); }
 };
 
+// The change in position from moving in each direction, indexed by
+// `Direction::T`.
+constexpr std::array<Point, 7> kMoveOffsets{{
+    {1, -1},  // eNorth
+    {1, 0},   // eNorthEast
+    {0, 1},   // eSouthEast
+    {-1, 1},  // eSouth
+    {-1, 0},  // eSouthWest
+    {0, -1},  // eNorthWest
+    {0, 0}    // eNone
+}};
+
+// A list of the points surrounding a point, and the direction to each of them.
+// There are never more than six, so they're stored inline instead of on the
+// heap.
+class NeighborList {
+ public:
+  typedef std::pair<Point, Direction::T> value_type;
+  typedef value_type* iterator;
+  typedef const value_type* const_iterator;
+
+ private:
+  std::array<value_type, 6> items;
+  size_t count;
+
+ public:
+  NeighborList() : count(0) {}
+
+  inline void push_back(const value_type& item) { items[count++] = item; }
+
+  inline size_t size() const { return count; }
+  inline bool empty() const { return count == 0; }
+
+  inline iterator begin() { return items.data(); }
+  inline iterator end() { return items.data() + count; }
+  inline const_iterator begin() const { return items.data(); }
+  inline const_iterator end() const { return items.data() + count; }
+
+  inline const value_type& operator[](size_t i) const { return items[i]; }
+
+  // Throws an exception if `i` is past the end of the list.
+  inline const value_type& at(size_t i) const {
+    if(i >= count) {
+      throw std::out_of_range("NeighborList index out of range.");
+    }
+    return items[i];
+  }
+
+  inline bool operator==(const NeighborList& rhs) const {
+    return count == rhs.count && std::equal(begin(), end(), rhs.begin());
+  }
+
+  inline bool operator!=(const NeighborList& rhs) const {
+    return !operator==(rhs);
+  }
+};
+
+// How the roughness of each hex is packed in memory. Every encoding has the
+// same behavior, and only differs in how much memory the map takes up.
+enum class Encoding : char {
+  eWide,    // One `uint` per hex.
+  eByte,    // One byte per hex.
+  eNibble,  // Two hexes per byte.
+};
+
+constexpr Encoding kDefaultEncoding = Encoding::eByte;
+
+// Returns a human readable name for the given `Encoding`.
+const char* encodingName(Encoding encoding);
+
+// How the rows of hexes are arranged in memory.
+enum class Layout : char {
+  // Rows are packed directly after each other.
+  eDense,
+  // The map is surrounded by a one hex ring of sentinels with a roughness of
+  // zero. This allows neighbors to be found without any bounds checks.
+  ePadded,
+};
+
+constexpr Layout kDefaultLayout = Layout::eDense;
+
+// Read-only roughness cells that live outside of any map, like a memory mapped
+// file. The cells are packed exactly as a map with the same dimensions,
+// encoding, and layout would pack them.
+class CellStorage {
+ public:
+  virtual const unsigned char* data() const = 0;
+  virtual size_t size() const = 0;
+
+  virtual ~CellStorage() {}
+};
+
+// The roughness cells of a map. The cells are either owned, or shared
+// read-only from a `CellStorage`. Shared cells are never copied until `own`
+// is called, so copies of a map made from a file all read the same memory.
+class CellBuffer {
+  std::vector<unsigned char> owned;
+  std::shared_ptr<const CellStorage> shared;
+  // Where the cells are read from, in either `owned` or `shared`.
+  const unsigned char* cells;
+
+  inline void bind() { cells = shared ? shared->data() : owned.data(); }
+
+ public:
+  CellBuffer() : cells(nullptr) {}
+  CellBuffer(const CellBuffer& other)
+      : owned(other.owned), shared(other.shared) {
+    bind();
+  }
+  CellBuffer(CellBuffer&& other) noexcept
+      : owned(std::move(other.owned)), shared(std::move(other.shared)) {
+    bind();
+    other.bind();
+  }
+  CellBuffer& operator=(CellBuffer other) noexcept {
+    owned.swap(other.owned);
+    shared.swap(other.shared);
+    bind();
+    return *this;
+  }
+
+  inline const unsigned char& operator[](size_t i) const { return cells[i]; }
+  inline const unsigned char* data() const { return cells; }
+
+  inline bool isShared() const { return shared != nullptr; }
+  inline size_t size() const { return shared ? shared->size() : owned.size(); }
+  // The bytes of memory the cells take up.
+  inline size_t capacity() const {
+    return shared ? shared->size() : owned.capacity();
+  }
+
+  // Lets go of every cell, and the memory they were in.
+  void release() {
+    std::vector<unsigned char>().swap(owned);
+    shared.reset();
+    bind();
+  }
+
+  // Replaces the cells with `size` owned zeros.
+  void assign(size_t size) {
+    shared.reset();
+    owned.assign(size, 0);
+    bind();
+  }
+
+  // Replaces the cells with shared ones.
+  void share(std::shared_ptr<const CellStorage> storage) {
+    std::vector<unsigned char>().swap(owned);
+    shared = std::move(storage);
+    bind();
+  }
+
+  // Copies shared cells so they can be changed.
+  void own() {
+    if(shared) {
+      owned.assign(shared->data(), shared->data() + shared->size());
+      shared.reset();
+      bind();
+    }
+  }
+
+  // The cells can only be written once they're owned.
+  inline unsigned char* writable() { return owned.data(); }
+};
+
 // The `RallyMap` represents the hex map that the rally takes place on. For
 // simple storage and displaying the underlying structure is a rhombus. Each hex
 // has a roughness score. The time it takes to move from one hex to another is
@@ -77,7 +250,76 @@ class RallyMap {
   Point start;
   Point finish;
 
-  std::vector<std::vector<uint>> roughness;
+  // Row-major roughness values packed according to `encoding`. The hex at
+  // (x, y) is cell number `origin + y * stride + x`. Cells loaded from a file
+  // are shared until the map is changed.
+  Encoding encoding;
+  Layout layout;
+  uint stride;
+  uint origin;
+  CellBuffer cells;
+
+  // The difference in cell number from moving in each direction, indexed by
+  // `Direction::T`.
+  std::array<int, 7> cellOffsets;
+
+  // Identifies the roughness of the map. See `getTerrainId`.
+  uint64_t terrainId;
+  // The hexes changed by `setRoughness` since the roughness was last set as a
+  // whole, each with the terrain id from before the change. Only the latest
+  // `kMaxEdits` are kept.
+  std::vector<std::pair<uint64_t, Point>> edits;
+
+  inline uint index(const Point& pos) const {
+    return origin + static_cast<uint>(pos.y) * stride +
+           static_cast<uint>(pos.x);
+  }
+
+  inline uint cellRoughness(uint cell) const {
+    switch(encoding) {
+      case Encoding::eByte:
+        return cells[cell];
+      case Encoding::eNibble:
+        return (cells[cell >> 1] >> ((cell & 1) << 2)) & 0xF;
+      default: {
+        uint value;
+        std::memcpy(&value, &cells[static_cast<size_t>(cell) * sizeof(uint)],
+                    sizeof(uint));
+        return value;
+      }
+    }
+  }
+
+  // The cells must be owned.
+  inline void setCellRoughness(uint cell, uint value) {
+    switch(encoding) {
+      case Encoding::eByte:
+        cells.writable()[cell] = static_cast<unsigned char>(value);
+        break;
+      case Encoding::eNibble: {
+        const uint shift = (cell & 1) << 2;
+        unsigned char& packed = cells.writable()[cell >> 1];
+        packed = static_cast<unsigned char>((packed & ~(0xF << shift)) |
+                                            (value << shift));
+        break;
+      }
+      default:
+        std::memcpy(cells.writable() + static_cast<size_t>(cell) * sizeof(uint),
+                    &value, sizeof(uint));
+        break;
+    }
+  }
+
+  // Sets `stride`, `origin`, and `cellOffsets` for the current dimensions and
+  // layout.
+  void computeStrides();
+
+  // Resizes `cells` to fit the current dimensions, encoding, and layout. The
+  // roughness of every hex, and every sentinel, is left at zero.
+  void allocateCells();
+
+  // Converts the map to the given encoding and layout.
+  void repack(Encoding nEncoding, Layout nLayout);
 
  public:
   inline uint getHeight() const { return height; }
@@ -86,12 +328,52 @@ class RallyMap {
   inline Point getStart() const { return start; }
   inline Point getFinish() const { return finish; }
 
+  // The distance between the start of two consecutive rows in the underlying
+  // roughness buffer.
+  inline uint getStride() const { return stride; }
+
+  inline Encoding getEncoding() const { return encoding; }
+  // Repacks the roughness of every hex with the given encoding.
+  void setEncoding(Encoding nEncoding);
+
+  inline Layout getLayout() const { return layout; }
+  // Rearranges the roughness of every hex with the given layout.
+  void setLayout(Layout nLayout);
+
+  // The number of bytes used to store the roughness of the map.
+  size_t getMemoryFootprint() const;
+  // The packed roughness cells, `memoryFootprint` bytes of them. These are
+  // what a `CellStorage` has to hold to recreate the map.
+  inline const unsigned char* getCellData() const { return cells.data(); }
+  // True if the cells are shared from a `CellStorage` rather than owned.
+  inline bool sharesCells() const { return cells.isShared(); }
+
+  // Every time the roughness of a map is set or changed it's given a new id,
+  // which copies of the map share. Two maps with the same id have the same
+  // roughness everywhere, so agents can keep what they learn about the
+  // terrain between races. Changing the encoding, layout, or end points keeps
+  // the id.
+  inline uint64_t getTerrainId() const { return terrainId; }
+  // Appends the hexes `setRoughness` changed since the map had the given
+  // terrain id to `edited`. Returns false if the map's roughness has been set
+  // as a whole since then, or if too many hexes were changed, in which case
+  // nothing is appended.
+  bool getEditsSince(uint64_t oldTerrainId, std::vector<Point>& edited) const;
+  static constexpr size_t kMaxEdits = 1024;
+  // The number of bytes needed to store the roughness of a map with the given
+  // encoding, dimensions, and layout.
+  static size_t memoryFootprint(Encoding encoding,
+                                uint width,
+                                uint height,
+                                Layout layout = kDefaultLayout);
+
   // This throws an exception if the start and finish are the same or if
   // either point is outside of the map.
   void setEndPoints(Point nStart, Point nFinish);
 
   // Sets the start and finish to random Points.
   void randomizeEndPoints();
+  void randomizeEndPoints(Random& random);
 
   // Throws an exception if the position is out of bounds.
   uint getRoughness(Point pos) const;
@@ -99,8 +381,10 @@ class RallyMap {
   // Values above the max roughness are set to the max.
   // Throws an exception if the position is out of bounds.
   void setRoughness(Point pos, uint newRoughness);
+  void setRoughness(Point pos, uint newRoughness, Random& random);
   // Randomizes the roughness of the entire map.
   void randomizeRoughness();
+  void randomizeRoughness(Random& random);
 
   std::vector<std::vector<uint>> getAllRoughness() const;
   // The map is resized and the roughness is set based on the given template.
@@ -112,12 +396,25 @@ class RallyMap {
   void setMap(Point start,
               Point finish,
               const std::vector<std::vector<uint>>& mapTemplate);
+  void setMap(Point start,
+              Point finish,
+              const std::vector<std::vector<uint>>& mapTemplate,
+              Random& random);
 
-  // Creates a random map with the given dimensions.
+  // Creates a random map with the given dimensions. Without a `Random` the
+  // map is different every run.
   //
   // Throws an exception if either of the template's dimensions are smaller
   // than two.
-  RallyMap(uint width, uint height);
+  RallyMap(uint width,
+           uint height,
+           Encoding encoding = kDefaultEncoding,
+           Layout layout = kDefaultLayout);
+  RallyMap(uint width,
+           uint height,
+           Random& random,
+           Encoding encoding = kDefaultEncoding,
+           Layout layout = kDefaultLayout);
   // Creates a map from the given template. This works the same way as calling
   // `setMap`.
   //
@@ -125,7 +422,24 @@ class RallyMap {
   // than two or if the template is jagged.
   RallyMap(Point startPos,
            Point finishPos,
-           const std::vector<std::vector<uint>>& mapTemplate);
+           const std::vector<std::vector<uint>>& mapTemplate,
+           Encoding encoding = kDefaultEncoding,
+           Layout layout = kDefaultLayout);
+
+  // Creates a map that reads its roughness straight from `storage`, without
+  // copying it. The map stays read-only until it's changed, at which point it
+  // copies the cells and lets go of the storage.
+  //
+  // Throws an exception if either dimension is smaller than two, the end
+  // points aren't valid, the storage is the wrong size, or any cell holds a
+  // roughness the map couldn't have made itself.
+  RallyMap(uint width,
+           uint height,
+           Point startPos,
+           Point finishPos,
+           Encoding encoding,
+           Layout layout,
+           std::shared_ptr<const CellStorage> storage);
 
   // Calculates the cost of the path, and if it ends on the finish.
   std::pair<uint, bool> analyzePath(
@@ -137,7 +451,11 @@ class RallyMap {
 
   // Creates a list of all the points surrounding the given one, and the
   // direction to that point.
-  std::vector<std::pair<Point, Direction::T>> getNeighbors(Point pos) const;
+  NeighborList getNeighbors(Point pos) const;
+  // Creates a list of the points surrounding the given one that are worth
+  // checking after arriving there by moving in `parentDir`. See
+  // `Direction::kForwardDirections`.
+  NeighborList getRelevantNeighbors(Point pos, Direction::T parentDir) const;
 
   // Determines the cost of moving in a given direction. If the move goes out
   // of bounds the agent returns to their starting position. This is not the
@@ -0,0 +1,77 @@
+#ifndef MAP_RANDOM_H_
+#define MAP_RANDOM_H_
+
+#include <cstdint>
+
+typedef unsigned int uint;
+
+namespace Rally {
+
+// A small and fast random number generator (xoshiro256**). Unlike `rand()` each
+// instance has its own state, so separate instances can be used on separate
+// threads, and the same seed always gives the same sequence on every platform.
+class Random {
+  uint64_t state[4];
+
+  static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+ public:
+  // The seed is spread over the whole state with splitmix64, so similar seeds
+  // still give unrelated sequences.
+  explicit Random(uint64_t seed);
+
+  // Mixes a seed and a stream number into a new seed. This is used to give
+  // each race its own generator, so a race is the same no matter what order
+  // or what thread it's run on.
+  static uint64_t deriveSeed(uint64_t seed, uint64_t stream);
+
+  // A seed that is different every run.
+  static uint64_t randomSeed();
+
+  // A generator for the current thread with a seed that is different every
+  // run. Used when a generator isn't given explicitly.
+  static Random& local();
+
+  inline uint64_t next() {
+    const uint64_t result = rotl(state[1] * 5, 7) * 9;
+    const uint64_t t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+
+    return result;
+  }
+
+  // A number in the range [0, bound). The bias is at most bound / 2^32, which
+  // doesn't matter for the small bounds used here.
+  inline uint below(uint bound) {
+    return static_cast<uint>(((next() >> 32) * bound) >> 32);
+  }
+
+  // Fills `count` values in the range [1, max] by calling `out(i, value)`.
+  // Two values are taken from each number generated, which makes filling
+  // large maps about twice as fast as calling `below` for every value.
+  template <class Output>
+  void fillRange(uint64_t count, uint max, Output out) {
+    uint64_t i = 0;
+    for(; i + 1 < count; i += 2) {
+      const uint64_t bits = next();
+      out(i, static_cast<uint>(((bits >> 32) * max) >> 32) + 1);
+      out(i + 1, static_cast<uint>(((bits & 0xFFFFFFFF) * max) >> 32) + 1);
+    }
+
+    if(i < count) {
+      out(i, below(max) + 1);
+    }
+  }
+};
+
+}  // namespace Rally
+
+#endif /* MAP_RANDOM_H_ */
@@ -0,0 +1,187 @@
+#ifndef SEARCH_ARENA_H_
+#define SEARCH_ARENA_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Rally {
+
+// A monotonic allocator for the scratch memory of a single race. Allocating
+// only moves a pointer forwards, and nothing is freed until `release` is
+// called, which frees everything at once.
+//
+// Released memory is kept for the next race. If a race needed more than one
+// block, they are replaced by a single block large enough for all of them, so
+// after the first few races an agent allocates nothing from the heap.
+class Arena {
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  static constexpr size_t kMinBlockBytes = 64 * 1024;
+
+  std::vector<Block> blocks;
+  char* next;
+  char* end;
+
+  // Adds a block with room for at least `bytes` bytes at the given alignment.
+  void grow(size_t bytes, size_t alignment) {
+    size_t size = bytes + alignment;
+    if(!blocks.empty() && size < blocks.back().size * 2) {
+      size = blocks.back().size * 2;
+    }
+    if(size < kMinBlockBytes) {
+      size = kMinBlockBytes;
+    }
+
+    blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+    next = blocks.back().data.get();
+    end = next + size;
+  }
+
+ public:
+  Arena() : next(nullptr), end(nullptr) {}
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  Arena(Arena&& other)
+      : blocks(std::move(other.blocks)), next(other.next), end(other.end) {
+    other.next = nullptr;
+    other.end = nullptr;
+  }
+
+  Arena& operator=(Arena&& other) {
+    blocks = std::move(other.blocks);
+    next = other.next;
+    end = other.end;
+    other.next = nullptr;
+    other.end = nullptr;
+
+    return *this;
+  }
+
+  // Returns `bytes` bytes of memory aligned to `alignment`, which must be a
+  // power of two.
+  inline void* allocate(size_t bytes, size_t alignment) {
+    if(bytes == 0) {
+      bytes = 1;
+    }
+
+    void* ptr = next;
+    size_t space = end - next;
+    if(next == nullptr || std::align(alignment, bytes, ptr, space) == nullptr) {
+      grow(bytes, alignment);
+      ptr = next;
+      space = end - next;
+      std::align(alignment, bytes, ptr, space);
+    }
+
+    next = static_cast<char*>(ptr) + bytes;
+    return ptr;
+  }
+
+  // Frees everything allocated since the last release. Nothing allocated from
+  // the arena may be used afterwards.
+  void release() {
+    if(blocks.size() > 1) {
+      const size_t size = capacity();
+      blocks.clear();
+      blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+    }
+
+    if(!blocks.empty()) {
+      next = blocks.front().data.get();
+      end = next + blocks.front().size;
+    }
+  }
+
+  // The bytes held by the arena, whether used or not.
+  size_t capacity() const {
+    size_t total = 0;
+    for(const auto& block : blocks) {
+      total += block.size;
+    }
+
+    return total;
+  }
+
+  size_t getNumBlocks() const { return blocks.size(); }
+};
+
+// Lets standard containers allocate from an `Arena`. Deallocating does nothing,
+// the memory is only reclaimed when the arena is released.
+template <class T>
+class ArenaAllocator {
+  template <class U>
+  friend class ArenaAllocator;
+
+  Arena* arena;
+
+ public:
+  typedef T value_type;
+
+  // Not explicit, so an `Arena` can be passed wherever a container expects an
+  // allocator.
+  ArenaAllocator(Arena& arena) : arena(&arena) {}
+
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+  inline T* allocate(size_t n) {
+    return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  inline void deallocate(T*, size_t) {}
+
+  template <class U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena == other.arena;
+  }
+
+  template <class U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena != other.arena;
+  }
+};
+
+// Standard containers that allocate from an `Arena`. They are all constructed
+// from the arena, for example `ArenaVector<Point> points(api->getArena())`.
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+template <class T, class Compare = std::less<T>>
+using ArenaSet = std::set<T, Compare, ArenaAllocator<T>>;
+
+template <class Key,
+          class Value,
+          class Hash = std::hash<Key>,
+          class Equal = std::equal_to<Key>>
+using ArenaUnorderedMap =
+    std::unordered_map<Key,
+                       Value,
+                       Hash,
+                       Equal,
+                       ArenaAllocator<std::pair<const Key, Value>>>;
+
+// A min priority queue that allocates from an `Arena`.
+template <class T, class Compare = std::greater<T>>
+class ArenaPriorityQueue
+    : public std::priority_queue<T, ArenaVector<T>, Compare> {
+  typedef std::priority_queue<T, ArenaVector<T>, Compare> Base;
+
+ public:
+  explicit ArenaPriorityQueue(Arena& arena)
+      : Base(Compare(), ArenaVector<T>(arena)) {}
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_ARENA_H_ */
@@ -0,0 +1,107 @@
+#ifndef SEARCH_BUCKET_QUEUE_H_
+#define SEARCH_BUCKET_QUEUE_H_
+
+#include <stdexcept>
+#include <vector>
+
+typedef unsigned int uint;
+
+namespace Rally {
+
+// A circular bucket queue, as used in Dial's algorithm. It is a min priority
+// queue for integer keys where the keys are monotone, meaning no key pushed is
+// smaller than the current smallest key. Every key must also be within
+// `maxStep` of the current smallest key, which is the case in Dijkstra's
+// algorithm when no edge costs more than `maxStep`.
+//
+// Both `push` and `pop` take constant time. Values with the same key are
+// popped in the reverse order they were pushed.
+template <class T>
+class BucketQueue {
+  std::vector<std::vector<T>> buckets;
+
+  // The bucket holding values with the key `currentKey`.
+  size_t cursor;
+  uint currentKey;
+  size_t count;
+
+  // Moves the cursor up to the first non-empty bucket.
+  inline void advance() {
+    while(buckets[cursor].empty()) {
+      ++currentKey;
+
+      if(++cursor == buckets.size()) {
+        cursor = 0;
+      }
+    }
+  }
+
+ public:
+  explicit BucketQueue(uint maxStep)
+      : buckets(maxStep + 1), cursor(0), currentKey(0), count(0) {}
+
+  inline bool empty() const { return count == 0; }
+  inline size_t size() const { return count; }
+
+  // Throws an exception if the key is smaller than the current smallest key,
+  // or if it is more than `maxStep` larger than it. An empty queue accepts any
+  // key.
+  inline void push(uint key, const T& value) {
+    if(count == 0) {
+      if(key < currentKey || key - currentKey >= buckets.size()) {
+        currentKey = key;
+      }
+    } else {
+      // The cursor may be lagging behind the smallest key.
+      if(key >= currentKey && key - currentKey >= buckets.size()) {
+        advance();
+      }
+
+      if(key < currentKey || key - currentKey >= buckets.size()) {
+        throw std::range_error("key outside of the bucket queue's range");
+      }
+    }
+
+    size_t bucket = cursor + (key - currentKey);
+    if(bucket >= buckets.size()) {
+      bucket -= buckets.size();
+    }
+
+    buckets[bucket].push_back(value);
+    ++count;
+  }
+
+  // The smallest key in the queue. The queue must not be empty.
+  inline uint topKey() {
+    advance();
+    return currentKey;
+  }
+
+  // A value with the smallest key in the queue. The queue must not be empty.
+  inline const T& top() {
+    advance();
+    return buckets[cursor].back();
+  }
+
+  // Removes the value returned by `top`. The queue must not be empty.
+  inline void pop() {
+    advance();
+    buckets[cursor].pop_back();
+    --count;
+  }
+
+  // Removes every value while keeping the memory already allocated.
+  void clear() {
+    for(auto& bucket : buckets) {
+      bucket.clear();
+    }
+
+    cursor = 0;
+    currentKey = 0;
+    count = 0;
+  }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_BUCKET_QUEUE_H_ */
@@ -0,0 +1,147 @@
+#ifndef SEARCH_CLUSTER_GRAPH_H_
+#define SEARCH_CLUSTER_GRAPH_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "map/hex-direction.h"
+#include "map/rally-map.h"
+#include "search/bucket-queue.h"
+#include "search/generation-stamps.h"
+#include "search/reusable-heap.h"
+#include "search/terrain-cache.h"
+
+namespace Rally {
+
+// Dijkstra's algorithm confined to a rectangle of hexes, as used inside a
+// single cluster. Move costs are small integers, so the frontier is a bucket
+// queue. The state is kept so it can be reused without allocating.
+class LocalSearch {
+  Point bottomLeft;
+  Point topRight;
+  uint expansions;
+
+  GenerationStamps stamps;
+  std::vector<uint> costs;
+  std::vector<Direction::T> parentDirs;
+  BucketQueue<uint> frontier;
+
+  inline size_t index(const Point& pos) const {
+    return static_cast<size_t>(pos.y - bottomLeft.y) *
+               (topRight.x - bottomLeft.x) +
+           static_cast<size_t>(pos.x - bottomLeft.x);
+  }
+
+ public:
+  LocalSearch()
+      : expansions(0), frontier(kMaxRoughness * 2) {}
+
+  // Finds the cheapest path from `source` to every hex from `bottomLeft` up to
+  // but not including `topRight`, without leaving the rectangle. The search
+  // stops early once `target` is reached, if it's given.
+  void run(const TerrainCache& terrain,
+           Point source,
+           Point bottomLeft,
+           Point topRight,
+           Point target = {-1, -1});
+
+  // Whether the search reached the hex.
+  inline bool isReached(const Point& pos) const {
+    return pos.inBounds(bottomLeft, topRight) &&
+           stamps.isMarked(index(pos));
+  }
+
+  // The cost of the cheapest path from the source to a reached hex.
+  inline uint getCost(const Point& pos) const { return costs[index(pos)]; }
+
+  // The number of hexes expanded by the last `run`.
+  inline uint getExpansions() const { return expansions; }
+
+  // Appends the moves from the source to a reached hex.
+  void appendPathTo(Point pos, std::vector<Direction::T>& path) const;
+  // Appends the moves from a reached hex back to the source.
+  void appendPathFrom(Point pos, std::vector<Direction::T>& path) const;
+};
+
+// The abstract graph of hierarchical pathfinding (HPA*). The map is split into
+// square clusters of hexes. Where two clusters touch, a few of the cheapest
+// crossings between them are picked as entrances, and the hexes on either side
+// become nodes of the graph. Nodes in the same cluster are joined by the cost
+// of the cheapest path between them that stays in the cluster, and the two
+// sides of an entrance are joined by the cost of the move across.
+//
+// A query searches the small abstract graph instead of the map, and then
+// refines each abstract edge into moves with a search confined to one cluster.
+// The paths found are close to the cheapest, but not always the cheapest.
+class ClusterGraph {
+  struct Node {
+    Point pos;
+    uint cluster;
+  };
+
+  struct Edge {
+    uint to;
+    uint cost;
+  };
+
+  uint clusterSize;
+  uint width;
+  uint height;
+  uint clustersX;
+  uint clustersY;
+
+  std::vector<Node> nodes;
+  // The cheapest paths to the other nodes of the same cluster.
+  std::vector<std::vector<Edge>> intraEdges;
+  // The nodes on the other side of an entrance. The cost of the move depends
+  // on the end points of the race, so it's looked up in the `TerrainCache`.
+  std::vector<std::vector<uint>> interEdges;
+  std::vector<std::vector<uint>> clusterNodes;
+
+  // The state of a query, kept so queries don't allocate.
+  uint expansions;
+  GenerationStamps stamps;
+  std::vector<uint> costs;
+  std::vector<uint> parents;
+  ReusableHeap<std::pair<uint, uint>> frontier;
+  LocalSearch startSearch;
+  LocalSearch finishSearch;
+  LocalSearch refineSearch;
+
+  inline uint clusterOf(const Point& pos) const {
+    return (pos.y / clusterSize) * clustersX + pos.x / clusterSize;
+  }
+
+  Point clusterBottomLeft(uint cluster) const;
+  Point clusterTopRight(uint cluster) const;
+
+  // Recomputes the edges between the nodes of a cluster.
+  void buildCluster(const TerrainCache& terrain, uint cluster);
+
+ public:
+  static constexpr uint kDefaultClusterSize = 16;
+
+  explicit ClusterGraph(uint clusterSize = kDefaultClusterSize);
+
+  // Builds the graph for every hex in the cache.
+  void build(const TerrainCache& terrain);
+  // Updates the graph after the roughness of the given hexes changed.
+  void repair(const TerrainCache& terrain, const std::vector<Point>& changed);
+
+  // Finds a path from `start` to `finish` on the terrain the graph was built
+  // for.
+  std::vector<Direction::T> findPath(const TerrainCache& terrain,
+                                     Point start,
+                                     Point finish);
+
+  // The number of nodes and hexes expanded by the last `findPath`, counting
+  // the searches within clusters.
+  inline uint getExpansions() const { return expansions; }
+
+  inline size_t getNumNodes() const { return nodes.size(); }
+  inline size_t getNumClusters() const { return clusterNodes.size(); }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_CLUSTER_GRAPH_H_ */
@@ -0,0 +1,157 @@
+#ifndef SEARCH_CONTRACTION_HIERARCHY_H_
+#define SEARCH_CONTRACTION_HIERARCHY_H_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "map/hex-direction.h"
+#include "map/rally-map.h"
+#include "search/generation-stamps.h"
+#include "search/reusable-heap.h"
+#include "search/terrain-cache.h"
+
+namespace Rally {
+
+// A contraction hierarchy over the hexes of a map. Every hex is given a rank,
+// and the hexes are removed from the map one at a time from the lowest rank
+// up. Whenever removing a hex would make the cheapest path between two of its
+// neighbors longer, a shortcut edge is added between them. A query only ever
+// follows edges towards higher ranks, from both ends at once, so it looks at
+// a tiny part of the map.
+//
+// The cost of a path is the roughness of both end points plus twice the
+// roughness of every hex in between. Edges only store the part between their
+// ends, so the roughness of the end points can be looked up when the edge is
+// used. That way the start and finish of a race, which always count as one,
+// don't need a hierarchy of their own. Hexes whose roughness isn't known yet
+// are ranked last and never have a shortcut through them, so learning them
+// later doesn't change the hierarchy.
+//
+// Hexes are numbered by rank, so the high ranks every query reaches are close
+// together in memory. Everything a query needs, roughness included, can be
+// written to a stream and read back, so the preprocessing of a map can be
+// kept.
+class ContractionHierarchy {
+ public:
+  static constexpr uint kNoMiddle = UINT32_MAX;
+
+  // An edge towards a hex of higher rank. Hexes are given by their rank.
+  struct Edge {
+    uint to;
+    // Twice the roughness of every hex between the ends of the edge.
+    uint cost;
+    // The hex a shortcut was made around, or `kNoMiddle` for a single move.
+    uint middle;
+  };
+
+ private:
+  uint width;
+  uint height;
+  // The index of the hex with each rank, and the rank of each hex.
+  std::vector<uint> hexes;
+  std::vector<uint> ranks;
+  std::vector<unsigned char> roughness;
+  // The edges of rank `i` are from `firstEdges[i]` up to `firstEdges[i + 1]`.
+  std::vector<uint> firstEdges;
+  std::vector<Edge> edges;
+
+  // Appends the ranks along an edge of `low`, not including the first. They
+  // go from `low` to the end of the edge, or back if `downwards` is set.
+  void appendRanks(uint low,
+                   const Edge& edge,
+                   bool downwards,
+                   std::vector<uint>& out) const;
+  const Edge& findEdge(uint low, uint high) const;
+
+  friend class HierarchyQuery;
+
+ public:
+  ContractionHierarchy();
+
+  // Contracts every hex of the cache. The hexes the cache doesn't know the
+  // roughness of yet are ranked last.
+  void build(const TerrainCache& terrain);
+  // Takes the roughness of hexes the cache has learned since the hierarchy
+  // was built.
+  void update(const TerrainCache& terrain, const std::vector<Point>& changed);
+
+  inline uint getWidth() const { return width; }
+  inline uint getHeight() const { return height; }
+  inline size_t getNumEdges() const { return edges.size(); }
+  inline uint getRank(const Point& pos) const {
+    return ranks[static_cast<size_t>(pos.y) * width + pos.x];
+  }
+
+  // Writes the hierarchy in a binary format. Every number is little endian.
+  //
+  //   Offset  Size  Field
+  //        0     8  "RALLYCH" and a zero.
+  //        8     4  Version, currently `kVersion`.
+  //       12     4  Width.
+  //       16     4  Height.
+  //       20     4  The number of edges.
+  //       24     -  The index of the hex with each rank, in 4 bytes.
+  //        -     -  The roughness of each rank, in 1 byte.
+  //        -     -  The number of edges of each rank, in 4 bytes.
+  //        -     -  Every edge as its end, cost and middle, in 4 bytes each.
+  //
+  // Throws an exception if the stream can't be written to.
+  void write(std::ostream& out) const;
+  // Reads a hierarchy written by `write`. Throws an exception if the stream
+  // doesn't hold a valid hierarchy.
+  void read(std::istream& in);
+
+  static constexpr uint32_t kVersion = 1;
+};
+
+// The state of a query on a `ContractionHierarchy`, kept so queries don't
+// allocate.
+class HierarchyQuery {
+  // One direction of the search.
+  struct Side {
+    GenerationStamps stamps;
+    std::vector<uint> costs;
+    // The rank each rank was reached from, and which of its edges was
+    // followed.
+    std::vector<std::pair<uint, uint>> parents;
+    ReusableHeap<std::pair<uint, uint>> frontier;
+  };
+
+  uint source;
+  uint target;
+  uint expansions;
+  Side forward;
+  Side backward;
+  std::vector<uint> ranks;
+
+  inline uint roughnessOf(const ContractionHierarchy& hierarchy,
+                          uint rank) const {
+    return rank == source || rank == target ? 1 : hierarchy.roughness[rank];
+  }
+
+  // Settles the next rank of `side`, and returns the cost of the cheapest
+  // path through it to the end of `other`, or `UINT32_MAX` if there isn't one
+  // yet.
+  uint step(const ContractionHierarchy& hierarchy,
+            Side& side,
+            const Side& other);
+
+ public:
+  HierarchyQuery();
+
+  // Finds the cheapest path from `start` to `finish`, where the two count as
+  // having a roughness of one like the start and finish of a race.
+  std::vector<Direction::T> findPath(const ContractionHierarchy& hierarchy,
+                                     Point start,
+                                     Point finish);
+
+  // The number of ranks settled by the last `findPath`, on both sides.
+  inline uint getExpansions() const { return expansions; }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_CONTRACTION_HIERARCHY_H_ */
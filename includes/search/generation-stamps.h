@@ -0,0 +1,42 @@
+#ifndef SEARCH_GENERATION_STAMPS_H_
+#define SEARCH_GENERATION_STAMPS_H_
+
+#include <algorithm>
+#include <vector>
+
+typedef unsigned int uint;
+
+namespace Rally {
+
+// Which slots of a search's arrays have been written since the search
+// started. Each slot is stamped with the generation it was marked in, so
+// starting a new search only bumps the generation, and the arrays can be
+// reused without clearing any memory.
+class GenerationStamps {
+  uint generation;
+  std::vector<uint> stamps;
+
+ public:
+  GenerationStamps() : generation(0) {}
+
+  // Unmarks every slot, and makes room for `size` of them. Memory is only
+  // touched if `size` is larger than any seen before.
+  void reset(size_t size) {
+    if(size > stamps.size()) {
+      stamps.resize(size, 0);
+    }
+
+    // When the generation wraps around old stamps could look current again.
+    if(++generation == 0) {
+      std::fill(stamps.begin(), stamps.end(), 0);
+      generation = 1;
+    }
+  }
+
+  inline bool isMarked(size_t i) const { return stamps[i] == generation; }
+  inline void mark(size_t i) { stamps[i] = generation; }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_GENERATION_STAMPS_H_ */
@@ -0,0 +1,101 @@
+#ifndef SEARCH_INCREMENTAL_SEARCH_H_
+#define SEARCH_INCREMENTAL_SEARCH_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "map/hex-direction.h"
+#include "map/rally-map.h"
+#include "search/reusable-heap.h"
+#include "search/terrain-cache.h"
+
+namespace Rally {
+
+// D* Lite (Koenig and Likhachev), a search that can find the cheapest path
+// again after the roughness of some hexes changes, or after the start moves,
+// without starting over.
+//
+// The search runs backwards from the finish, so every hex it has settled
+// holds the cost of the cheapest path from there to the finish. Each hex also
+// has a lookahead, the cost it would get from its neighbors' costs. When the
+// roughness of a hex changes, only the hexes whose lookahead changes with it
+// are queued again, and the search only goes as far as those changes reach
+// the path from the start. Moving the start changes the distances the queue
+// is ordered by, so rather than reorder the queue, the keys already in it are
+// treated as if they were smaller by how far the start has moved.
+//
+// The roughness of every hex is kept in the search, and the start and finish
+// count as one like in a race.
+class IncrementalSearch {
+  uint width;
+  uint height;
+  Point start;
+  Point finish;
+  // How much the keys in the queue may be too small since the start moved.
+  uint keyModifier;
+  uint expansions;
+
+  std::vector<unsigned char> roughness;
+  std::vector<uint> costs;
+  std::vector<uint> lookaheads;
+  // The key each hex is queued with, or `kNotQueued`. Entries in `frontier`
+  // with another key are out of date.
+  std::vector<uint64_t> queuedKeys;
+  ReusableHeap<std::pair<uint64_t, uint>> frontier;
+
+  static constexpr uint kUnreached = UINT32_MAX;
+  static constexpr uint64_t kNotQueued = UINT64_MAX;
+
+  inline size_t index(const Point& pos) const {
+    return static_cast<size_t>(pos.y) * width + static_cast<size_t>(pos.x);
+  }
+
+  inline Point pointAt(size_t hex) const {
+    return {static_cast<int>(hex % width), static_cast<int>(hex / width)};
+  }
+
+  inline uint roughnessOf(const Point& pos) const {
+    return pos == start || pos == finish ? 1 : roughness[index(pos)];
+  }
+
+  // Ordered by the smaller of the cost and lookahead plus a lower bound on
+  // the cost to the start, and then by the smaller of the cost and lookahead.
+  uint64_t keyOf(size_t hex) const;
+
+  // The cheapest way from the hex to the finish through one of its neighbors.
+  uint lookaheadOf(const Point& pos) const;
+  // Queues the hex if its cost and lookahead differ, and takes it out of the
+  // queue otherwise.
+  void queue(size_t hex);
+  // Finds the lookahead of the hex and its neighbors again, after the cost
+  // of moving to or from the hex changed.
+  void updateAround(const Point& pos);
+  // Settles hexes until the cost of the start is known.
+  void computeCosts();
+
+ public:
+  IncrementalSearch();
+
+  // Forgets everything, and starts a new search between the given end points
+  // with the roughness of the cache.
+  void reset(const TerrainCache& terrain, Point nStart, Point nFinish);
+
+  // Reports a change in the roughness of a hex.
+  void setRoughness(Point pos, uint nRoughness);
+  // Moves the start. The finish can't be moved without starting over.
+  void setStart(Point pos);
+
+  // Finds the cheapest path from the start to the finish, repairing the
+  // search after any changes since the last path.
+  std::vector<Direction::T> findPath();
+
+  inline Point getStart() const { return start; }
+  inline Point getFinish() const { return finish; }
+  // The number of hexes expanded by the last `findPath`.
+  inline uint getExpansions() const { return expansions; }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_INCREMENTAL_SEARCH_H_ */
@@ -0,0 +1,117 @@
+#ifndef SEARCH_LANDMARKS_H_
+#define SEARCH_LANDMARKS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "map/rally-map.h"
+#include "search/bucket-queue.h"
+#include "search/terrain-cache.h"
+
+namespace Rally {
+
+// Landmarks for the ALT lower bound (A*, landmarks and the triangle
+// inequality). The cost of the cheapest path from a few landmark hexes to
+// every hex is kept in a table. Moves cost the same both ways, so for any
+// landmark `L` the cheapest path from `a` to `b` costs at least
+// `|cost(L, b) - cost(L, a)|`. Unlike the distance between the hexes, this
+// knows about the rough terrain in between.
+//
+// The landmarks are picked one at a time as the hex farthest from the ones
+// picked so far, starting from the hex farthest from a corner, so they end up
+// spread around the edges of the map.
+//
+// The tables are built from the roughness the cache knows. The start and
+// finish of a later race count as one, so they can be cheaper than in the
+// tables, which `LandmarkBound` makes up for. The hexes the cache doesn't know
+// yet are built as one, which is the lowest they can turn out to be, so the
+// tables stay a lower bound as they're learned.
+class Landmarks {
+  uint count;
+  uint width;
+  uint height;
+  std::vector<Point> landmarks;
+  // The roughness of every hex the tables were built with.
+  std::vector<unsigned char> roughness;
+  // The cost from every landmark to each hex. The costs of a hex are next to
+  // each other, so a bound only touches the memory of two hexes.
+  std::vector<uint> costs;
+
+  // The state of the search from a landmark.
+  std::vector<uint> searchCosts;
+  BucketQueue<uint> frontier;
+
+  // Finds the cost from `source` to every hex into `searchCosts`.
+  void search(Point source);
+
+ public:
+  static constexpr uint kDefaultCount = 8;
+
+  explicit Landmarks(uint count = kDefaultCount);
+
+  // Picks the landmarks for the terrain of the cache, and builds their tables.
+  void build(const TerrainCache& terrain);
+
+  inline const std::vector<Point>& getLandmarks() const { return landmarks; }
+
+  inline size_t index(const Point& pos) const {
+    return static_cast<size_t>(pos.y) * width + static_cast<size_t>(pos.x);
+  }
+
+  // The costs from every landmark to the hex.
+  inline const uint* getCosts(const Point& pos) const {
+    return &costs[index(pos) * landmarks.size()];
+  }
+
+  // The roughness the tables were built with.
+  inline uint getRoughness(const Point& pos) const {
+    return roughness[index(pos)];
+  }
+};
+
+// The lower bound the landmarks give on the cost of the cheapest path from any
+// hex to one target, in a race from `start` to `finish`.
+class LandmarkBound {
+  const Landmarks* landmarks;
+  const uint* targetCosts;
+  // A path through the start or finish can be cheaper in the race than in the
+  // tables, by twice their roughness in the tables beyond one.
+  uint slack;
+  // The end point that isn't the target, where a search towards the target
+  // starts. Leaving it is cheaper in the race than in the tables, so its bound
+  // is lowered to keep the bound consistent on the moves away from it.
+  Point source;
+  uint sourceSlack;
+
+ public:
+  LandmarkBound(const Landmarks& nLandmarks,
+                Point target,
+                Point start,
+                Point finish)
+      : landmarks(&nLandmarks),
+        targetCosts(nLandmarks.getCosts(target)),
+        slack((nLandmarks.getRoughness(start) - 1) * 2 +
+              (nLandmarks.getRoughness(finish) - 1) * 2),
+        source(target == start ? finish : start),
+        sourceSlack(slack + nLandmarks.getRoughness(source) - 1) {}
+
+  inline uint operator()(const Point& pos) const {
+    const uint* posCosts = landmarks->getCosts(pos);
+    const size_t count = landmarks->getLandmarks().size();
+
+    uint bound = 0;
+    for(size_t i = 0; i < count; ++i) {
+      const uint a = posCosts[i];
+      const uint b = targetCosts[i];
+      bound = std::max(bound, a > b ? a - b : b - a);
+    }
+
+    const uint posSlack = pos == source ? sourceSlack : slack;
+    return bound > posSlack ? bound - posSlack : 0;
+  }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_LANDMARKS_H_ */
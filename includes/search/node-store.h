@@ -0,0 +1,95 @@
+#ifndef SEARCH_NODE_STORE_H_
+#define SEARCH_NODE_STORE_H_
+
+#include <stdexcept>
+#include <vector>
+
+#include "map/rally-map.h"
+#include "search/generation-stamps.h"
+
+namespace Rally {
+
+// A dense replacement for `std::unordered_map<Point, Info>` in search agents.
+// There is a slot for every hex on the map indexed by `y * width + x`, so
+// finding a point is a single array access.
+//
+// The inserted slots are tracked with `GenerationStamps`, so the store can be
+// reused across races without clearing any memory.
+template <class Info>
+class NodeStore {
+  uint width;
+  uint height;
+
+  GenerationStamps stamps;
+  std::vector<Info> infos;
+
+ public:
+  NodeStore() : width(0), height(0) {}
+
+  // Forgets every point, and makes room for a map with the given dimensions.
+  // Memory is only touched if the map is larger than any seen before.
+  void reset(uint nWidth, uint nHeight) {
+    width = nWidth;
+    height = nHeight;
+
+    const size_t nodes = static_cast<size_t>(width) * height;
+    if(nodes > infos.size()) {
+      infos.resize(nodes);
+    }
+
+    stamps.reset(nodes);
+  }
+
+  inline size_t index(const Point& pos) const {
+    return static_cast<size_t>(pos.y) * width + static_cast<size_t>(pos.x);
+  }
+
+  inline bool contains(const Point& pos) const {
+    return stamps.isMarked(index(pos));
+  }
+
+  // Returns nullptr if the point hasn't been inserted.
+  inline Info* find(const Point& pos) {
+    const size_t i = index(pos);
+    return stamps.isMarked(i) ? &infos[i] : nullptr;
+  }
+
+  inline const Info* find(const Point& pos) const {
+    const size_t i = index(pos);
+    return stamps.isMarked(i) ? &infos[i] : nullptr;
+  }
+
+  // Throws an exception if the point hasn't been inserted.
+  inline Info& at(const Point& pos) {
+    Info* info = find(pos);
+
+    if(info == nullptr) {
+      throw std::out_of_range("point not in the node store");
+    }
+
+    return *info;
+  }
+
+  inline const Info& at(const Point& pos) const {
+    const Info* info = find(pos);
+
+    if(info == nullptr) {
+      throw std::out_of_range("point not in the node store");
+    }
+
+    return *info;
+  }
+
+  // Inserts or overwrites the info for the given point.
+  inline Info& insert(const Point& pos, const Info& info) {
+    const size_t i = index(pos);
+    stamps.mark(i);
+    infos[i] = info;
+
+    return infos[i];
+  }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_NODE_STORE_H_ */
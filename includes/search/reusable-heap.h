@@ -0,0 +1,25 @@
+#ifndef SEARCH_REUSABLE_HEAP_H_
+#define SEARCH_REUSABLE_HEAP_H_
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace Rally {
+
+// A min priority queue that can be emptied without giving up its memory, so
+// an agent can keep one between races. `std::priority_queue` has no `clear`,
+// but its container is accessible to derived classes.
+template <class T>
+class ReusableHeap
+    : public std::priority_queue<T, std::vector<T>, std::greater<T>> {
+ public:
+  // Removes every value while keeping the memory already allocated.
+  void clear() { this->c.clear(); }
+
+  size_t capacity() const { return this->c.capacity(); }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_REUSABLE_HEAP_H_ */
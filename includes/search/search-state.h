@@ -0,0 +1,127 @@
+#ifndef SEARCH_SEARCH_STATE_H_
+#define SEARCH_SEARCH_STATE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "map/hex-direction.h"
+#include "map/rally-map.h"
+#include "search/generation-stamps.h"
+
+namespace Rally {
+
+// The state of a search over the hexes of a map, stored as a structure of
+// arrays. Each array is indexed by `y * width + x`. Only the fields a search
+// touches on every expansion are kept:
+//  - The cost of the shortest path found to each hex.
+//  - The roughness of each hex, so known move costs don't need a map look.
+//  - The direction moved to reach each hex. The parent hex is recovered by
+//    moving backwards, so it isn't stored. The 3 bit direction is packed into
+//    half of a byte so it never spans two bytes.
+//  - Whether each hex has been closed, as a bitset.
+//
+// Like `NodeStore`, the reached hexes are tracked with `GenerationStamps`, so
+// the state can be reused across races without clearing any memory. The
+// closed bit of a hex is cleared when the hex is first reached.
+class SearchState {
+  uint width;
+  uint height;
+
+  GenerationStamps stamps;
+  std::vector<uint> costs;
+  std::vector<unsigned char> roughness;
+  std::vector<unsigned char> parentDirs;
+  std::vector<uint64_t> closedBits;
+
+ public:
+  SearchState() : width(0), height(0) {}
+
+  // Forgets every hex, and makes room for a map with the given dimensions.
+  // Memory is only touched if the map is larger than any seen before.
+  void reset(uint nWidth, uint nHeight) {
+    width = nWidth;
+    height = nHeight;
+
+    const size_t nodes = static_cast<size_t>(width) * height;
+    if(nodes > costs.size()) {
+      costs.resize(nodes);
+      roughness.resize(nodes);
+      parentDirs.resize((nodes + 1) / 2);
+      closedBits.resize((nodes + 63) / 64);
+    }
+
+    stamps.reset(nodes);
+  }
+
+  inline size_t index(const Point& pos) const {
+    return static_cast<size_t>(pos.y) * width + static_cast<size_t>(pos.x);
+  }
+
+  // Whether the hex has been reached since the last reset.
+  inline bool isReached(size_t i) const { return stamps.isMarked(i); }
+
+  // Marks a hex as reached for the first time since the last reset.
+  inline void reach(size_t i,
+                    uint cost,
+                    uint hexRoughness,
+                    Direction::T parentDir) {
+    stamps.mark(i);
+    costs[i] = cost;
+    roughness[i] = static_cast<unsigned char>(hexRoughness);
+    setParentDir(i, parentDir);
+    closedBits[i >> 6] &= ~(uint64_t(1) << (i & 63));
+  }
+
+  inline uint getCost(size_t i) const { return costs[i]; }
+  inline void setCost(size_t i, uint cost) { costs[i] = cost; }
+
+  inline uint getRoughness(size_t i) const { return roughness[i]; }
+
+  inline Direction::T getParentDir(size_t i) const {
+    return static_cast<Direction::T>((parentDirs[i >> 1] >> ((i & 1) << 2)) &
+                                     0xF);
+  }
+
+  inline void setParentDir(size_t i, Direction::T dir) {
+    const uint shift = (i & 1) << 2;
+    unsigned char& packed = parentDirs[i >> 1];
+    packed = static_cast<unsigned char>((packed & ~(0xF << shift)) |
+                                        (static_cast<uint>(dir) << shift));
+  }
+
+  // Only valid for hexes that have been reached.
+  inline bool isClosed(size_t i) const {
+    return (closedBits[i >> 6] >> (i & 63)) & 1;
+  }
+
+  inline void close(size_t i) { closedBits[i >> 6] |= uint64_t(1) << (i & 63); }
+
+  // Opens every hex again, for searches that can expand a hex more than once.
+  void openAll() {
+    const size_t nodes = static_cast<size_t>(width) * height;
+    std::fill(closedBits.begin(), closedBits.begin() + (nodes + 63) / 64, 0);
+  }
+
+  // Follows the parent directions back from the given hex to the hex the
+  // search started from, and returns the directions moved to get there in
+  // order.
+  std::vector<Direction::T> tracePath(Point pos) const {
+    std::vector<Direction::T> path;
+    Direction::T dir = getParentDir(index(pos));
+
+    while(dir != Direction::T::eNone) {
+      path.push_back(dir);
+      pos = pos - kMoveOffsets[static_cast<size_t>(dir)];
+      dir = getParentDir(index(pos));
+    }
+
+    std::reverse(path.begin(), path.end());
+
+    return path;
+  }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_SEARCH_STATE_H_ */
@@ -0,0 +1,87 @@
+#ifndef SEARCH_TERRAIN_CACHE_H_
+#define SEARCH_TERRAIN_CACHE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "map/map-interface.h"
+#include "map/rally-map.h"
+
+namespace Rally {
+
+// The roughness of every hex of a map, learned through a `MapInterface` and
+// kept between races on the same terrain. Agents that preprocess the whole map
+// use it so the preprocessing can be reused for every race on that terrain.
+//
+// Learning the whole map takes one map look per hex. The start and finish of a
+// race always look like they have a roughness of one, so their real roughness
+// is only learned in a later race on the same terrain, once they're no longer
+// the start or finish.
+//
+// A cache can also follow the edits `RallyMap::setRoughness` makes, and then
+// it only learns the edited hexes again instead of the whole map. The
+// roughness of an edited hex can go down, so agents whose preprocessing only
+// holds while the roughness goes up leave this off.
+class TerrainCache {
+  bool followsEdits;
+  uint64_t terrainId;
+  uint width;
+  uint height;
+  Point start;
+  Point finish;
+
+  std::vector<unsigned char> roughness;
+  // Hexes that were the start or finish when they were learned.
+  std::vector<Point> unknown;
+  // Edited hexes that haven't been learned again yet.
+  std::vector<Point> pending;
+
+  void learnAll(MapInterface* api);
+  // Learns a single hex with one map look. Returns false if it can't be
+  // learned yet, because none of its neighbors are known.
+  bool learnHex(MapInterface* api, Point pos, uint& value) const;
+  // Learns the hexes edited since the cached terrain again. Returns false if
+  // the map doesn't know what was edited, or if some of the edited hexes
+  // can't be learned on their own.
+  bool learnEdits(MapInterface* api, std::vector<Point>& changed);
+
+ public:
+  explicit TerrainCache(bool followsEdits = false);
+
+  // Brings the cache up to date with the race. Returns true if the whole map
+  // had to be learned, because the cache held a different terrain. Otherwise
+  // the hexes whose roughness turned out to be different from what was
+  // cached are added to `changed`. When following edits, the hexes edited
+  // since the cached terrain are among them.
+  bool update(MapInterface* api, std::vector<Point>& changed);
+
+  // The hexes whose real roughness hasn't been learned yet, because they were
+  // the start or finish of every race on the terrain so far.
+  inline const std::vector<Point>& getUnknown() const { return unknown; }
+
+  inline uint getWidth() const { return width; }
+  inline uint getHeight() const { return height; }
+
+  inline bool inBounds(const Point& pos) const {
+    return pos.inBounds(0, 0, width, height);
+  }
+
+  inline size_t index(const Point& pos) const {
+    return static_cast<size_t>(pos.y) * width + static_cast<size_t>(pos.x);
+  }
+
+  // The roughness of the hex in the current race, where the start and finish
+  // count as one.
+  inline uint getRoughness(const Point& pos) const {
+    return pos == start || pos == finish ? 1 : roughness[index(pos)];
+  }
+
+  // The cost of moving between two neighboring hexes in the current race.
+  inline uint getMoveCost(const Point& pos, const Point& dest) const {
+    return getRoughness(pos) + getRoughness(dest);
+  }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_TERRAIN_CACHE_H_ */
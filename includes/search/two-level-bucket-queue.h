@@ -0,0 +1,185 @@
+#ifndef SEARCH_TWO_LEVEL_BUCKET_QUEUE_H_
+#define SEARCH_TWO_LEVEL_BUCKET_QUEUE_H_
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+typedef unsigned int uint;
+
+namespace Rally {
+
+// A min priority queue ordered by a primary key and then by a secondary key,
+// as needed by A* where the frontier is ordered by the estimated full path
+// cost and ties are broken on the path cost so far.
+//
+// The primary keys are kept in a circular bucket queue, so like
+// `BucketQueue` the primary keys must be monotone and within `maxStep` of the
+// current smallest primary key. This is the case for A* with a consistent
+// heuristic. Each primary bucket keeps its values in buckets by secondary key,
+// which may be pushed in any order. Values with the same keys are popped in
+// the reverse order they were pushed.
+//
+// Every vector in the queue allocates from a copy of `Allocator`.
+template <class T, class Allocator = std::allocator<T>>
+class TwoLevelBucketQueue {
+  template <class U>
+  using Rebind =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+  typedef std::vector<T, Allocator> Slot;
+
+  // The values sharing a primary key, bucketed by their secondary key.
+  struct SecondaryBuckets {
+    // `slots[i]` holds the values with the secondary key `base + i`.
+    std::vector<Slot, Rebind<Slot>> slots;
+    uint base;
+    // Every slot before this one is empty.
+    size_t cursor;
+    size_t count;
+
+    explicit SecondaryBuckets(const Allocator& alloc)
+        : slots(alloc), base(0), cursor(0), count(0) {}
+
+    inline void push(uint key, const T& value) {
+      if(count == 0) {
+        // Start in the middle so keys on either side fit without growing.
+        const uint half = static_cast<uint>(slots.size() / 2);
+        base = key < half ? 0 : key - half;
+        cursor = slots.size();
+      }
+
+      if(key < base) {
+        // Grow towards smaller keys at least as much as the current size so
+        // growing is amortized constant time.
+        size_t grow = base - key;
+        if(grow < slots.size()) {
+          grow = slots.size() < base ? slots.size() : base;
+        }
+
+        slots.insert(slots.begin(), grow, Slot(slots.get_allocator()));
+        base -= static_cast<uint>(grow);
+        cursor += grow;
+      }
+
+      const size_t slot = key - base;
+      if(slot >= slots.size()) {
+        slots.resize(slot + 1 > slots.size() * 2 ? slot + 1 : slots.size() * 2,
+                     Slot(slots.get_allocator()));
+      }
+
+      slots[slot].push_back(value);
+      ++count;
+
+      if(slot < cursor) {
+        cursor = slot;
+      }
+    }
+
+    // Moves the cursor up to the first non-empty slot.
+    inline Slot& front() {
+      while(slots[cursor].empty()) {
+        ++cursor;
+      }
+
+      return slots[cursor];
+    }
+  };
+
+  std::vector<SecondaryBuckets, Rebind<SecondaryBuckets>> buckets;
+
+  // The bucket holding values with the primary key `currentKey`.
+  size_t cursor;
+  uint currentKey;
+  size_t count;
+
+  // Moves the cursor up to the first non-empty bucket.
+  inline void advance() {
+    while(buckets[cursor].count == 0) {
+      ++currentKey;
+
+      if(++cursor == buckets.size()) {
+        cursor = 0;
+      }
+    }
+  }
+
+ public:
+  explicit TwoLevelBucketQueue(uint maxStep,
+                               const Allocator& alloc = Allocator())
+      : buckets(maxStep + 1, SecondaryBuckets(alloc), alloc),
+        cursor(0),
+        currentKey(0),
+        count(0) {}
+
+  inline bool empty() const { return count == 0; }
+  inline size_t size() const { return count; }
+
+  // Throws an exception if the primary key is smaller than the current
+  // smallest primary key, or if it is more than `maxStep` larger than it. An
+  // empty queue accepts any primary key.
+  inline void push(uint primaryKey, uint secondaryKey, const T& value) {
+    if(count == 0) {
+      if(primaryKey < currentKey || primaryKey - currentKey >= buckets.size()) {
+        currentKey = primaryKey;
+      }
+    } else {
+      // The cursor may be lagging behind the smallest primary key.
+      if(primaryKey >= currentKey &&
+         primaryKey - currentKey >= buckets.size()) {
+        advance();
+      }
+
+      if(primaryKey < currentKey || primaryKey - currentKey >= buckets.size()) {
+        throw std::range_error("key outside of the bucket queue's range");
+      }
+    }
+
+    size_t bucket = cursor + (primaryKey - currentKey);
+    if(bucket >= buckets.size()) {
+      bucket -= buckets.size();
+    }
+
+    buckets[bucket].push(secondaryKey, value);
+    ++count;
+  }
+
+  // The smallest primary key in the queue. The queue must not be empty.
+  inline uint topKey() {
+    advance();
+    return currentKey;
+  }
+
+  // A value with the smallest keys in the queue. The queue must not be empty.
+  inline const T& top() {
+    advance();
+    return buckets[cursor].front().back();
+  }
+
+  // Removes the value returned by `top`. The queue must not be empty.
+  inline void pop() {
+    advance();
+    buckets[cursor].front().pop_back();
+    --buckets[cursor].count;
+    --count;
+  }
+
+  // Removes every value while keeping the memory already allocated.
+  void clear() {
+    for(auto& bucket : buckets) {
+      for(auto& slot : bucket.slots) {
+        slot.clear();
+      }
+
+      bucket.count = 0;
+    }
+
+    cursor = 0;
+    currentKey = 0;
+    count = 0;
+  }
+};
+
+}  // namespace Rally
+
+#endif /* SEARCH_TWO_LEVEL_BUCKET_QUEUE_H_ */
@@ -0,0 +1,19 @@
+#ifndef STATS_CLOCK_H_
+#define STATS_CLOCK_H_
+
+#include <cstdint>
+
+namespace Rally {
+
+// Nanoseconds on a monotonic clock. Only the difference between two readings
+// is meaningful.
+uint64_t wallNanos();
+
+// Nanoseconds of CPU time used by the calling thread. Where per thread CPU
+// time isn't available this falls back to the CPU time of the whole process,
+// which is only accurate when a single thread is running races.
+uint64_t threadCpuNanos();
+
+}  // namespace Rally
+
+#endif /* STATS_CLOCK_H_ */
@@ -0,0 +1,49 @@
+#ifndef STATS_HEAP_USAGE_H_
+#define STATS_HEAP_USAGE_H_
+
+#include <cstdint>
+
+namespace Rally {
+
+// Whether the allocation functions are replaced to count heap usage, which
+// only the builds configured with `HEAP_STATS` do. Without them every count
+// stays 0.
+bool heapStatsEnabled();
+
+// Heap bytes allocated through `operator new` on the calling thread that
+// haven't been freed yet. Memory freed on a different thread than it was
+// allocated on is taken off the freeing thread, so only differences measured
+// on one thread are meaningful.
+int64_t liveHeapBytes();
+
+// The number of calls to `operator new` made on the calling thread, and the
+// bytes they asked for, since the thread started.
+uint64_t heapAllocations();
+uint64_t heapAllocatedBytes();
+
+// Measures the most heap memory the calling thread had live at once while the
+// scope was open, above what was already live when it was opened, and how
+// much it allocated in total. Scopes can be nested.
+class HeapScope {
+  int64_t startBytes;
+  int64_t outerPeak;
+  uint64_t startAllocations;
+  uint64_t startAllocatedBytes;
+
+ public:
+  HeapScope();
+  ~HeapScope();
+
+  HeapScope(const HeapScope&) = delete;
+  HeapScope& operator=(const HeapScope&) = delete;
+
+  int64_t peakBytes() const;
+  // The number of allocations made since the scope was opened, whether or not
+  // they were freed again.
+  uint64_t allocations() const;
+  uint64_t allocatedBytes() const;
+};
+
+}  // namespace Rally
+
+#endif /* STATS_HEAP_USAGE_H_ */
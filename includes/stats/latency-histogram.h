@@ -0,0 +1,53 @@
+#ifndef STATS_LATENCY_HISTOGRAM_H_
+#define STATS_LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Rally {
+
+// Counts latencies in logarithmic buckets, so percentiles can be estimated
+// without keeping every sample. Each power of two is split into
+// `kSubBuckets` buckets, so an estimate is never off by more than 1 part in
+// `kSubBuckets`. Histograms can be merged, so races can be timed on separate
+// threads and combined afterwards.
+class LatencyHistogram {
+ public:
+  static constexpr uint64_t kSubBits = 3;
+  static constexpr uint64_t kSubBuckets = uint64_t(1) << kSubBits;
+
+ private:
+  // Values below `kSubBuckets` get a bucket each. Every power of two above
+  // that gets `kSubBuckets` buckets.
+  static constexpr size_t kNumBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+  std::array<uint64_t, kNumBuckets> buckets;
+  uint64_t count;
+  uint64_t total;
+  uint64_t maxValue;
+
+  static size_t bucketOf(uint64_t value);
+  // The largest value that is counted in the bucket.
+  static uint64_t bucketLimit(size_t bucket);
+
+ public:
+  LatencyHistogram();
+
+  void record(uint64_t value);
+  void merge(const LatencyHistogram& other);
+  void clear();
+
+  uint64_t getCount() const;
+  uint64_t getTotal() const;
+  uint64_t getMax() const;
+
+  // Estimates the value that `fraction` of the samples are at or below, for
+  // example 0.99 for the 99th percentile. The estimate never exceeds the
+  // largest sample. Returns 0 if nothing has been recorded.
+  uint64_t percentile(double fraction) const;
+};
+
+}  // namespace Rally
+
+#endif /* STATS_LATENCY_HISTOGRAM_H_ */
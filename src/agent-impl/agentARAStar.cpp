@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "agent/agent-impl.h"
+#include "search/arena.h"
+#include "search/search-state.h"
+
+using Rally::ArenaPriorityQueue;
+using Rally::ArenaVector;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::SearchState;
+
+namespace {
+
+// The weights the heuristic is multiplied by, in tenths. The first search is
+// greedy enough to find a path quickly, and each search after it is less
+// greedy, until the last one finds the cheapest path.
+constexpr uint kWeightScale = 10;
+constexpr uint kInitialWeight = 30;
+constexpr uint kWeightStep = 5;
+
+inline uint hueristic(const Point& a, const uint& aRoughness, const Point& b) {
+  return a == b ? 0 : (a.distanceTo(b) - 1) * 2 + aRoughness + 1;
+}
+
+// The frontier only lasts for one race, so it's allocated from the race's
+// arena instead of kept here.
+struct Scratch {
+  SearchState state;
+
+  void reset() {}
+};
+
+// A series of weighted A* searches that share their work, as in ARA*
+// (Likhachev, Gordon and Thrun). A search with weight `w` finds a path that
+// costs at most `w` times the cheapest path. Hexes that get cheaper after
+// they were expanded aren't expanded again in the same search, but are kept
+// for the next one, so each search only redoes the part of the last one the
+// lower weight changes.
+class AnytimeSearch {
+  MapInterface* const api;
+  SearchState& state;
+  const Point finish;
+  const size_t finishIndex;
+  uint weight;
+
+  ArenaPriorityQueue<std::pair<uint64_t, Point>> frontier;
+  // The hexes that got cheaper after they were expanded by this search.
+  ArenaVector<Point> inconsistent;
+  ArenaVector<Point> open;
+
+  inline uint64_t keyOf(const Point& pos, size_t i) const {
+    return static_cast<uint64_t>(state.getCost(i)) * kWeightScale +
+           static_cast<uint64_t>(weight) *
+               hueristic(pos, state.getRoughness(i), finish);
+  }
+
+ public:
+  AnytimeSearch(MapInterface* const api, SearchState& state)
+      : api(api),
+        state(state),
+        finish(api->getFinish()),
+        finishIndex(state.index(finish)),
+        weight(kInitialWeight),
+        frontier(api->getArena()),
+        inconsistent(api->getArena()),
+        open(api->getArena()) {
+    const Point start = api->getStart();
+    const size_t startIndex = state.index(start);
+
+    state.reach(startIndex, 0, 1, Direction::T::eNone);
+    frontier.push({keyOf(start, startIndex), start});
+  }
+
+  inline uint getWeight() const { return weight; }
+  inline bool reachedFinish() const { return state.isReached(finishIndex); }
+
+  // Expands hexes until no hex in the frontier could lead to a cheaper path
+  // to the finish with the current weight. Returns false if the budget ran
+  // out first, which is only checked if `checkBudget` is set.
+  bool improvePath(bool checkBudget) {
+    while(frontier.size() > 0) {
+      const uint64_t frontKey = frontier.top().first;
+      const Point frontPoint = frontier.top().second;
+
+      if(reachedFinish() &&
+         frontKey >=
+             static_cast<uint64_t>(state.getCost(finishIndex)) * kWeightScale) {
+        return true;
+      }
+
+      frontier.pop();
+
+      // Entries whose hex got cheaper since are out of date.
+      const size_t front = state.index(frontPoint);
+      if(state.isClosed(front) || frontKey != keyOf(frontPoint, front)) {
+        continue;
+      }
+
+      if(checkBudget && api->isOverBudget()) {
+        return false;
+      }
+
+      state.close(front);
+
+      const uint frontCost = state.getCost(front);
+      const uint frontRoughness = state.getRoughness(front);
+
+      for(const auto& near : api->getNeighbors(frontPoint)) {
+        const Point nearPoint = near.first;
+        const Direction::T nearDir = near.second;
+        const size_t nearIndex = state.index(nearPoint);
+
+        if(state.isReached(nearIndex)) {
+          const uint shortestPathCost =
+              frontCost + frontRoughness + state.getRoughness(nearIndex);
+
+          if(shortestPathCost >= state.getCost(nearIndex)) {
+            continue;
+          }
+
+          state.setCost(nearIndex, shortestPathCost);
+          state.setParentDir(nearIndex, nearDir);
+
+          if(state.isClosed(nearIndex)) {
+            inconsistent.push_back(nearPoint);
+          } else {
+            frontier.push({keyOf(nearPoint, nearIndex), nearPoint});
+          }
+        } else {
+          const uint moveCost = api->getMoveCost(frontPoint, nearDir);
+
+          state.reach(nearIndex, frontCost + moveCost,
+                      moveCost - frontRoughness, nearDir);
+          frontier.push({keyOf(nearPoint, nearIndex), nearPoint});
+        }
+      }
+    }
+
+    return true;
+  }
+
+  // After `improvePath` finishes, finds how many times the cheapest path the
+  // path to the finish costs at most. That's the weight, or less if none of
+  // the hexes left to expand could lead to a path much cheaper than it.
+  //
+  // The hexes left to expand are taken out of the frontier and kept, so they
+  // can be put back with the next weight.
+  double collectBound() {
+    const uint finishCost = state.getCost(finishIndex);
+    uint lowerBound = finishCost;
+
+    open.clear();
+    while(frontier.size() > 0) {
+      const uint64_t frontKey = frontier.top().first;
+      const Point frontPoint = frontier.top().second;
+      const size_t front = state.index(frontPoint);
+      frontier.pop();
+
+      // Closing the hex keeps it from being collected twice.
+      if(state.isClosed(front) || frontKey != keyOf(frontPoint, front)) {
+        continue;
+      }
+
+      state.close(front);
+      open.push_back(frontPoint);
+    }
+
+    open.insert(open.end(), inconsistent.begin(), inconsistent.end());
+    inconsistent.clear();
+
+    for(const Point& pos : open) {
+      const size_t i = state.index(pos);
+      lowerBound = std::min(
+          lowerBound,
+          state.getCost(i) + hueristic(pos, state.getRoughness(i), finish));
+    }
+
+    return std::min(static_cast<double>(weight) / kWeightScale,
+                    static_cast<double>(finishCost) / lowerBound);
+  }
+
+  // Lowers the weight, and puts the hexes kept by `collectBound` back in the
+  // frontier so the next `improvePath` can continue from them.
+  void lowerWeight() {
+    weight = std::max(weight - kWeightStep, kWeightScale);
+
+    state.openAll();
+    for(const Point& pos : open) {
+      frontier.push({keyOf(pos, state.index(pos)), pos});
+    }
+  }
+
+  std::vector<Direction::T> getPath() const {
+    return reachedFinish() ? state.tracePath(finish)
+                           : std::vector<Direction::T>();
+  }
+};
+
+}  // namespace
+
+// This agent is an anytime version of A*, an implementation of ARA*. A
+// greedy weighted A* finds a path quickly, and then the weight is lowered
+// step by step to find cheaper paths, until the cheapest path is found or the
+// race's budget runs out (see `SearchBudget`). The best path found so far is
+// returned, and how far from the cheapest it may be is reported through
+// `MapInterface::reportBound`. The first search always runs to the end, so
+// there is always a path with a bound to return.
+REGISTER_AGENT_WITH_SCRATCH(ARAStar, Scratch)(MapInterface* const api) {
+  SearchState& state = scratch.state;
+  state.reset(api->getWidth(), api->getHeight());
+
+  AnytimeSearch search(api, state);
+  bool checkBudget = false;
+
+  // Searches with a lower weight keep finding a path at least as cheap as the
+  // last one, so a search the budget cuts short still leaves a path within
+  // the last bound.
+  while(search.improvePath(checkBudget) && search.reachedFinish()) {
+    const double bound = search.collectBound();
+    api->reportBound(bound);
+
+    if(bound <= 1 || search.getWeight() == kWeightScale ||
+       api->isOverBudget()) {
+      break;
+    }
+
+    search.lowerWeight();
+    checkBudget = true;
+  }
+
+  return search.getPath();
+}
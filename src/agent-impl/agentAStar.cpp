@@ -1,12 +1,14 @@
 #include <algorithm>
 #include <cmath>
-#include <queue>
-#include <unordered_map>
 
 #include "agent/agent-impl.h"
+#include "search/node-store.h"
+#include "search/reusable-heap.h"
 
 using Rally::MapInterface;
+using Rally::NodeStore;
 using Rally::Point;
+using Rally::ReusableHeap;
 
 namespace {
 
@@ -22,28 +24,33 @@ inline uint hueristic(const Point& a, const Point& b) {
   return a.distanceTo(b) * 2;
 }
 
+struct Scratch {
+  NodeStore<PointInfo> pointMap;
+  ReusableHeap<std::pair<uint, Point>> frontier;
+
+  void reset() { frontier.clear(); }
+};
+
 }  // namespace
 
 // This agent is a standard implementation of the A* algorithm.
-REGISTER_AGENT(AStar)(MapInterface* const api) {
+REGISTER_AGENT_WITH_SCRATCH(AStar, Scratch)(MapInterface* const api) {
   const Point start = api->getStart();
   const Point finish = api->getFinish();
 
-  std::unordered_map<Point, PointInfo> pointMap;
-
-  pointMap.insert({start,
-                   PointInfo{
-                       0,                         // pathCost
-                       hueristic(start, finish),  // estimate
-                       {-1, -1},                  // parent
-                       Direction::T::eNone,       // parentDir
-                       false                      // expanded
-                   }});
-
-  std::priority_queue<std::pair<uint, Point>,
-                      std::vector<std::pair<uint, Point>>,
-                      std::greater<std::pair<uint, Point>>>
-      frontier;
+  NodeStore<PointInfo>& pointMap = scratch.pointMap;
+  pointMap.reset(api->getWidth(), api->getHeight());
+
+  pointMap.insert(start,
+                  PointInfo{
+                      0,                         // pathCost
+                      hueristic(start, finish),  // estimate
+                      {-1, -1},                  // parent
+                      Direction::T::eNone,       // parentDir
+                      false                      // expanded
+                  });
+
+  ReusableHeap<std::pair<uint, Point>>& frontier = scratch.frontier;
   frontier.push({hueristic(start, finish), start});
 
   // A* algorithm is run.
@@ -78,8 +85,9 @@ REGISTER_AGENT(AStar)(MapInterface* const api) {
       const uint pathCost =
           frontInfo->shortestPathCost + api->getMoveCost(frontPoint, nearDir);
 
-      if(pointMap.find(nearPoint) != pointMap.end()) {
-        PointInfo& nearInfo = pointMap.at(nearPoint);
+      PointInfo* const found = pointMap.find(nearPoint);
+      if(found != nullptr) {
+        PointInfo& nearInfo = *found;
 
         // If the point has been expanded the shortest distance is
         // already known.
@@ -96,13 +104,14 @@ REGISTER_AGENT(AStar)(MapInterface* const api) {
         }
       } else {
         const uint estimate = hueristic(nearPoint, finish);
-        pointMap.insert({nearPoint, PointInfo{
-                                        pathCost,    // pathCost
-                                        estimate,    // estimate
-                                        frontPoint,  // parent
-                                        nearDir,     // parentDir
-                                        false        // expanded
-                                    }});
+        pointMap.insert(nearPoint,
+                        PointInfo{
+                            pathCost,    // pathCost
+                            estimate,    // estimate
+                            frontPoint,  // parent
+                            nearDir,     // parentDir
+                            false        // expanded
+                        });
         frontier.push({pathCost + estimate, nearPoint});
       }
     }
@@ -1,59 +1,51 @@
 #include <algorithm>
 #include <cmath>
-#include <queue>
-#include <unordered_map>
 
 #include "agent/agent-impl.h"
-
+#include "search/arena.h"
+#include "search/landmarks.h"
+#include "search/search-state.h"
+#include "search/terrain-cache.h"
+#include "search/two-level-bucket-queue.h"
+
+using Rally::Arena;
+using Rally::LandmarkBound;
+using Rally::Landmarks;
 using Rally::MapInterface;
 using Rally::Point;
+using Rally::SearchState;
+using Rally::TerrainCache;
 
 namespace {
 
-struct PointInfo {
-  uint roughness;
-  uint shortestPathCost;
-  uint pathEstimate;
-  Point parent;
-  Direction::T parentDir;
-  bool expanded;
-};
-
 struct FrontierEntry {
   Point pos;
   uint shortestPathCost;
   uint pathEstimate;
+};
 
-  inline bool operator==(const FrontierEntry& rhs) {
-    // At the moment there is no need to check `pathEstimate` as the position
-    // being equal implies they are the same.
-    return this->pos == rhs.pos &&
-           this->shortestPathCost == rhs.shortestPathCost;
-  }
-
-  inline bool operator!=(const FrontierEntry& rhs) { return !operator==(rhs); }
-
-  inline bool operator<(const FrontierEntry& rhs) const {
-    if(this->shortestPathCost + this->pathEstimate ==
-       rhs.shortestPathCost + rhs.pathEstimate) {
-      // Note that this being greater than introduces bias.
-      return this->shortestPathCost > rhs.shortestPathCost;
-    }
+// With a consistent heuristic the estimated full path cost never grows by more
+// than twice the cost of a single move.
+constexpr uint kMaxEstimateStep = Rally::kMaxRoughness * 4;
 
-    return this->shortestPathCost + this->pathEstimate <
-           rhs.shortestPathCost + rhs.pathEstimate;
-  }
+// The frontier is ordered by the estimated full path cost. Ties go to the
+// entry with the larger path cost so far, which is the entry with the smaller
+// path estimate. Note that this introduces bias.
+class FrontierQueue {
+  Rally::TwoLevelBucketQueue<FrontierEntry,
+                             Rally::ArenaAllocator<FrontierEntry>>
+      queue;
 
-  inline bool operator>(const FrontierEntry& rhs) const {
-    return rhs.operator<(*this);
-  }
+ public:
+  explicit FrontierQueue(Arena& arena) : queue(kMaxEstimateStep, arena) {}
 
-  inline bool operator<=(const FrontierEntry& rhs) const {
-    return !operator>(rhs);
-  }
+  inline size_t size() const { return queue.size(); }
+  inline const FrontierEntry& top() { return queue.top(); }
+  inline void pop() { queue.pop(); }
 
-  inline bool operator>=(const FrontierEntry& rhs) const {
-    return !operator<(rhs);
+  inline void push(const FrontierEntry& entry) {
+    queue.push(entry.shortestPathCost + entry.pathEstimate, entry.pathEstimate,
+               entry);
   }
 };
 
@@ -61,64 +53,51 @@ inline uint hueristic(const Point& a, const uint& aRoughness, const Point& b) {
   return (a.distanceTo(b) - 1) * 2 + aRoughness + 1;
 }
 
-// All points other than the start have another point before them in the path.
-// There is never a lower cost for backtracking, so it's wasted effort to check
-// points that the previous point already checked. This cuts out those extra
-// map looks.
-std::vector<std::pair<Point, Direction::T>> getRelevantNeighbors(
-    Point pos,
-    Direction::T parentDir,
-    MapInterface* const api) {
-  std::vector<Direction::T> directions;
-
-  switch(parentDir) {
-    case Direction::T::eNorth:
-      directions = {Direction::T::eNorthWest, Direction::T::eNorth,
-                    Direction::T::eNorthEast};
-      break;
-    case Direction::T::eNorthEast:
-      directions = {Direction::T::eNorth, Direction::T::eNorthEast,
-                    Direction::T::eSouthEast};
-      break;
-    case Direction::T::eSouthEast:
-      directions = {Direction::T::eNorthEast, Direction::T::eSouthEast,
-                    Direction::T::eSouth};
-      break;
-    case Direction::T::eSouth:
-      directions = {Direction::T::eSouthEast, Direction::T::eSouth,
-                    Direction::T::eSouthWest};
-      break;
-    case Direction::T::eSouthWest:
-      directions = {Direction::T::eSouth, Direction::T::eSouthWest,
-                    Direction::T::eNorthWest};
-      break;
-    case Direction::T::eNorthWest:
-      directions = {Direction::T::eSouthWest, Direction::T::eNorthWest,
-                    Direction::T::eNorth};
-      break;
-    case Direction::T::eNone:
-      directions.assign(Direction::kAllMoveDirections.begin(),
-                        Direction::kAllMoveDirections.end());
+// The geometric bound, which only knows how far away the target is.
+struct GeometricBound {
+  Point target;
+
+  inline uint operator()(const Point& pos, uint posRoughness) const {
+    return hueristic(pos, posRoughness, target);
   }
+};
 
-  std::vector<std::pair<Point, Direction::T>> neighbors;
-  neighbors.reserve(3);
-  for(const auto& dir : directions) {
-    const auto near = api->getDestination(pos, dir);
+// The larger of the geometric bound and the landmark bound. Both are
+// consistent, so the larger one is as well.
+struct ALTBound {
+  GeometricBound geometric;
+  LandmarkBound landmarks;
 
-    if(near != pos) {
-      neighbors.push_back({near, dir});
-    }
+  inline uint operator()(const Point& pos, uint posRoughness) const {
+    return std::max(geometric(pos, posRoughness), landmarks(pos));
   }
+};
 
-  return neighbors;
-}
+// The frontier only lasts for one race, so it's allocated from the race's
+// arena instead of kept here.
+struct Scratch {
+  SearchState state;
 
-}  // namespace
+  void reset() {}
+};
 
-// This agent is an implementation of the A* algorithm that takes more
-// information about the specific problem being solved into account.
-REGISTER_AGENT(AStarOpt)(MapInterface* const api) {
+// Keeps the terrain and landmarks of the last race, so every race on the same
+// terrain shares the work of learning the map and building the tables.
+struct ALTScratch {
+  SearchState state;
+  TerrainCache terrain;
+  Landmarks landmarks;
+  std::vector<Point> changed;
+
+  void reset() { changed.clear(); }
+};
+
+// Runs A* from the start to the finish, with `estimate` giving a lower bound
+// on the cost from a hex to the finish.
+template <class Bound>
+std::vector<Direction::T> findPath(MapInterface* const api,
+                                   SearchState& state,
+                                   const Bound& estimate) {
   const Point start = api->getStart();
   const Point finish = api->getFinish();
 
@@ -129,99 +108,100 @@ REGISTER_AGENT(AStarOpt)(MapInterface* const api) {
     }
   }
 
-  std::unordered_map<Point, PointInfo> pointMap;
-  pointMap.insert({start,
-                   PointInfo{
-                       1,                            // roughness
-                       0,                            // shortestPathCost
-                       hueristic(start, 1, finish),  // pathEstimate
-                       {-1, -1},                     // parent
-                       Direction::T::eNone,          // parentDir
-                       false                         // expanded
-                   }});
-
-  std::priority_queue<FrontierEntry, std::vector<FrontierEntry>,
-                      std::greater<FrontierEntry>>
-      frontier;
-  frontier.push(FrontierEntry{start, 0, hueristic(start, 1, finish)});
+  state.reset(api->getWidth(), api->getHeight());
+  state.reach(state.index(start), 0, 1, Direction::T::eNone);
+
+  FrontierQueue frontier(api->getArena());
+  frontier.push(FrontierEntry{start, 0, estimate(start, 1)});
 
   // A* algorithm is run.
   while(frontier.size() > 0) {
     // A point might be in the frontier multiple times because the cost has
-    // been updated. The up to date cost is necessarily in `pointMap` so
-    // it's safe to ignore anything that doesn't match the cost there.
+    // been updated. The up to date cost is necessarily in `state` so it's
+    // safe to ignore anything that doesn't match the cost there.
     // This avoids the complexity of re-sorting or removing the redundant
     // points when the updated ones are inserted.
-    uint frontCost;
-    Point frontPoint;
-    PointInfo* frontInfo;
-    do {
-      frontPoint = frontier.top().pos;
-      frontInfo = &pointMap.at(frontPoint);
-      frontCost = frontier.top().shortestPathCost;
-
-      frontier.pop();
-
-    } while(!frontInfo->expanded && frontCost != frontInfo->shortestPathCost);
+    const FrontierEntry frontEntry = frontier.top();
+    const uint frontCost = frontEntry.shortestPathCost;
+    const Point frontPoint = frontEntry.pos;
+    const size_t front = state.index(frontPoint);
+    frontier.pop();
+
+    if(state.isClosed(front) || frontCost != state.getCost(front)) {
+      continue;
+    }
 
-    frontInfo->expanded = true;
+    state.close(front);
 
     if(frontPoint == finish) {
       break;
     }
 
+    const uint frontRoughness = state.getRoughness(front);
+
     for(const auto& near :
-        getRelevantNeighbors(frontPoint, frontInfo->parentDir, api)) {
+        api->getRelevantNeighbors(frontPoint, state.getParentDir(front))) {
       const Point nearPoint = near.first;
       const Direction::T nearDir = near.second;
+      const size_t nearIndex = state.index(nearPoint);
 
-      if(pointMap.find(nearPoint) != pointMap.end()) {
-        PointInfo& nearInfo = pointMap.at(nearPoint);
-
+      if(state.isReached(nearIndex)) {
         // If the point has been expanded the shortest distance is
         // already known.
-        if(nearInfo.expanded) {
+        if(state.isClosed(nearIndex)) {
           continue;
         }
 
-        uint shortestPathCost = frontInfo->shortestPathCost +
-                                frontInfo->roughness + nearInfo.roughness;
+        const uint nearRoughness = state.getRoughness(nearIndex);
+        const uint shortestPathCost =
+            frontCost + frontRoughness + nearRoughness;
 
-        if(shortestPathCost < nearInfo.shortestPathCost) {
-          nearInfo.shortestPathCost = shortestPathCost;
-          nearInfo.parent = frontPoint;
-          nearInfo.parentDir = nearDir;
+        if(shortestPathCost < state.getCost(nearIndex)) {
+          state.setCost(nearIndex, shortestPathCost);
+          state.setParentDir(nearIndex, nearDir);
 
-          frontier.push(FrontierEntry{nearPoint, shortestPathCost,
-                                      nearInfo.pathEstimate});
+          // The estimate is cheap to recompute, so it isn't stored.
+          frontier.push(
+              FrontierEntry{nearPoint, shortestPathCost,
+                            estimate(nearPoint, nearRoughness)});
         }
       } else {
         const uint moveCost = api->getMoveCost(frontPoint, nearDir);
-        const uint nearRoughness = moveCost - frontInfo->roughness;
-        const uint pathEstimate = hueristic(nearPoint, nearRoughness, finish);
-        const uint shortestPathCost = moveCost + frontInfo->shortestPathCost;
+        const uint nearRoughness = moveCost - frontRoughness;
+        const uint pathEstimate = estimate(nearPoint, nearRoughness);
+        const uint shortestPathCost = moveCost + frontCost;
 
-        pointMap.insert(
-            {nearPoint, PointInfo{nearRoughness, shortestPathCost, pathEstimate,
-                                  frontPoint, nearDir, false}});
+        state.reach(nearIndex, shortestPathCost, nearRoughness, nearDir);
         frontier.push(FrontierEntry{nearPoint, shortestPathCost, pathEstimate});
       }
     }
   }
 
   // Reverse the path from the finish.
-  std::vector<Direction::T> path;
-  Point tracePoint = finish;
-  Direction::T traceDir;
-
-  while(tracePoint != start) {
-    PointInfo info = pointMap.at(tracePoint);
-    tracePoint = info.parent;
-    traceDir = info.parentDir;
-    path.push_back(traceDir);
+  return state.tracePath(finish);
+}
+
+}  // namespace
+
+// This agent is an implementation of the A* algorithm that takes more
+// information about the specific problem being solved into account.
+REGISTER_AGENT_WITH_SCRATCH(AStarOpt, Scratch)(MapInterface* const api) {
+  return findPath(api, scratch.state, GeometricBound{api->getFinish()});
+}
+
+// The same A* with the ALT bound added. The whole map is learned once per
+// terrain to build the landmark tables, which is expensive, but the tighter
+// bound means every race after that expands far fewer hexes.
+REGISTER_AGENT_WITH_SCRATCH(AStarOptALT, ALTScratch)(MapInterface* const api) {
+  if(scratch.terrain.update(api, scratch.changed)) {
+    scratch.landmarks.build(scratch.terrain);
   }
 
-  std::reverse(path.begin(), path.end());
+  const Point start = api->getStart();
+  const Point finish = api->getFinish();
+  const ALTBound estimate{GeometricBound{finish},
+                          LandmarkBound(scratch.landmarks, finish, start,
+                                        finish)};
 
-  return path;
+  return findPath(api, scratch.state, estimate);
 }
@@ -0,0 +1,44 @@
+#include "agent/agent-impl.h"
+#include "search/contraction-hierarchy.h"
+#include "search/terrain-cache.h"
+
+using Rally::ContractionHierarchy;
+using Rally::HierarchyQuery;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::TerrainCache;
+
+namespace {
+
+// Kept between races, so every race on the same terrain shares the work of
+// learning the map and contracting it.
+struct Scratch {
+  TerrainCache terrain;
+  ContractionHierarchy hierarchy;
+  HierarchyQuery query;
+  std::vector<Point> changed;
+
+  void reset() { changed.clear(); }
+};
+
+}  // namespace
+
+// This agent answers races with a contraction hierarchy. The whole map is
+// learned and contracted once per terrain, which is slow, but every race after
+// that finds the cheapest path with a couple of map looks and a search over a
+// few hundred hexes.
+REGISTER_AGENT_WITH_SCRATCH(CH, Scratch)(MapInterface* const api) {
+  // Only the hexes the hierarchy was built without knowing can change, and
+  // those are never in the middle of a shortcut, so the hierarchy still holds.
+  if(scratch.terrain.update(api, scratch.changed)) {
+    scratch.hierarchy.build(scratch.terrain);
+  } else if(!scratch.changed.empty()) {
+    scratch.hierarchy.update(scratch.terrain, scratch.changed);
+  }
+
+  std::vector<Direction::T> path = scratch.query.findPath(
+      scratch.hierarchy, api->getStart(), api->getFinish());
+  api->addExpansions(scratch.query.getExpansions());
+
+  return path;
+}
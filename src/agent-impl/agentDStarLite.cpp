@@ -0,0 +1,52 @@
+#include "agent/agent-impl.h"
+#include "search/incremental-search.h"
+#include "search/terrain-cache.h"
+
+using Rally::IncrementalSearch;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::TerrainCache;
+
+namespace {
+
+// Kept between races, so a race to the same finish can repair the last
+// search instead of starting over. The cache follows the map's edits, so
+// only the hexes that were edited are learned again.
+struct Scratch {
+  TerrainCache terrain{true};
+  IncrementalSearch search;
+  std::vector<Point> changed;
+
+  void reset() { changed.clear(); }
+};
+
+}  // namespace
+
+// This agent is an implementation of D* Lite. The whole map is learned once
+// per terrain, and a backwards search from the finish is kept. When the next
+// race goes to the same finish, the hexes edited since the last race and the
+// move of the start are fed to the search, which only repairs the part of it
+// they affect. Any other race starts a new search.
+REGISTER_AGENT_WITH_SCRATCH(DStarLite, Scratch)(MapInterface* const api) {
+  const Point start = api->getStart();
+  const Point finish = api->getFinish();
+
+  if(scratch.terrain.update(api, scratch.changed) ||
+     finish != scratch.search.getFinish()) {
+    scratch.search.reset(scratch.terrain, start, finish);
+  } else {
+    // The old start counts with its real roughness again, which the cache
+    // may know by now.
+    scratch.changed.push_back(scratch.search.getStart());
+    scratch.search.setStart(start);
+
+    for(const Point& pos : scratch.changed) {
+      scratch.search.setRoughness(pos, scratch.terrain.getRoughness(pos));
+    }
+  }
+
+  std::vector<Direction::T> path = scratch.search.findPath();
+  api->addExpansions(scratch.search.getExpansions());
+
+  return path;
+}
@@ -1,12 +1,14 @@
 #include <algorithm>
 #include <cmath>
-#include <queue>
-#include <unordered_map>
 
 #include "agent/agent-impl.h"
+#include "search/node-store.h"
+#include "search/reusable-heap.h"
 
 using Rally::MapInterface;
+using Rally::NodeStore;
 using Rally::Point;
+using Rally::ReusableHeap;
 
 namespace {
 struct PointInfo {
@@ -15,25 +17,30 @@ struct PointInfo {
   Direction::T parentDir;
   bool expanded;
 };
+
+struct Scratch {
+  NodeStore<PointInfo> pointMap;
+  ReusableHeap<std::pair<uint, Point>> frontier;
+
+  void reset() { frontier.clear(); }
+};
 }  // namespace
 
 // This is a standard implementation of Dijkstra's algorithm.
-REGISTER_AGENT(Dijkstra)(MapInterface* const api) {
+REGISTER_AGENT_WITH_SCRATCH(Dijkstra, Scratch)(MapInterface* const api) {
   const Point start = api->getStart();
   const Point finish = api->getFinish();
-  std::unordered_map<Point, PointInfo> pointMap;
-  pointMap.insert({start,
-                   PointInfo{
-                       0,                    // shortestPathCost
-                       {-1, -1},             // parent
-                       Direction::T::eNone,  // parentDir
-                       false                 // expanded
-                   }});
-
-  std::priority_queue<std::pair<uint, Point>,
-                      std::vector<std::pair<uint, Point>>,
-                      std::greater<std::pair<uint, Point>>>
-      frontier;
+  NodeStore<PointInfo>& pointMap = scratch.pointMap;
+  pointMap.reset(api->getWidth(), api->getHeight());
+  pointMap.insert(start,
+                  PointInfo{
+                      0,                    // shortestPathCost
+                      {-1, -1},             // parent
+                      Direction::T::eNone,  // parentDir
+                      false                 // expanded
+                  });
+
+  ReusableHeap<std::pair<uint, Point>>& frontier = scratch.frontier;
   frontier.push({0, start});
 
   // Dijkstra's algorithm is run.
@@ -68,8 +75,9 @@ REGISTER_AGENT(Dijkstra)(MapInterface* const api) {
       const uint pathCost =
           frontInfo->shortestPathCost + api->getMoveCost(frontPoint, nearDir);
 
-      if(pointMap.find(nearPoint) != pointMap.end()) {
-        PointInfo& nearInfo = pointMap.at(nearPoint);
+      PointInfo* const found = pointMap.find(nearPoint);
+      if(found != nullptr) {
+        PointInfo& nearInfo = *found;
 
         // If the point has been expanded the shortest distance is
         // already known.
@@ -85,12 +93,13 @@ REGISTER_AGENT(Dijkstra)(MapInterface* const api) {
           frontier.push({pathCost, nearPoint});
         }
       } else {
-        pointMap.insert({nearPoint, PointInfo{
-                                        pathCost,    // shortestPathCost
-                                        frontPoint,  // parent
-                                        nearDir,     // parentDir
-                                        false        // expanded
-                                    }});
+        pointMap.insert(nearPoint,
+                        PointInfo{
+                            pathCost,    // shortestPathCost
+                            frontPoint,  // parent
+                            nearDir,     // parentDir
+                            false        // expanded
+                        });
         frontier.push({pathCost, nearPoint});
       }
     }
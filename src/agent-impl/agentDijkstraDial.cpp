@@ -0,0 +1,97 @@
+#include "agent/agent-impl.h"
+#include "search/bucket-queue.h"
+#include "search/search-state.h"
+
+using Rally::BucketQueue;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::SearchState;
+
+namespace {
+
+// No single move can cost more than moving between two of the roughest hexes.
+constexpr uint kMaxMoveCost = Rally::kMaxRoughness * 2;
+
+struct Scratch {
+  SearchState state;
+  BucketQueue<Point> frontier;
+
+  Scratch() : frontier(kMaxMoveCost) {}
+
+  void reset() { frontier.clear(); }
+};
+
+}  // namespace
+
+// This agent is the same as DijkstraOpt, but it takes advantage of the move
+// costs being small integers. The frontier is a bucket queue (Dial's
+// algorithm) instead of a binary heap, so pushing and popping the frontier
+// takes constant time.
+REGISTER_AGENT_WITH_SCRATCH(DijkstraDial, Scratch)(MapInterface* const api) {
+  const Point start = api->getStart();
+  const Point finish = api->getFinish();
+  SearchState& state = scratch.state;
+  state.reset(api->getWidth(), api->getHeight());
+  state.reach(state.index(start), 0, 1, Direction::T::eNone);
+
+  BucketQueue<Point>& frontier = scratch.frontier;
+  frontier.push(0, start);
+
+  // Dijkstra's algorithm is run.
+  while(!frontier.empty()) {
+    // A point might be in the frontier multiple times because the cost has
+    // been updated. The up to date cost is necessarily in `state` so it's
+    // safe to ignore anything that doesn't match the cost there.
+    const uint frontCost = frontier.topKey();
+    const Point frontPoint = frontier.top();
+    const size_t front = state.index(frontPoint);
+
+    frontier.pop();
+
+    if(state.isClosed(front) || frontCost != state.getCost(front)) {
+      continue;
+    }
+
+    state.close(front);
+
+    if(frontPoint == finish) {
+      break;
+    }
+
+    const uint frontRoughness = state.getRoughness(front);
+
+    for(const auto& near :
+        api->getRelevantNeighbors(frontPoint, state.getParentDir(front))) {
+      const Point nearPoint = near.first;
+      const Direction::T nearDir = near.second;
+      const size_t nearIndex = state.index(nearPoint);
+
+      if(state.isReached(nearIndex)) {
+        // If the point has been expanded the shortest distance is
+        // already known.
+        if(state.isClosed(nearIndex)) {
+          continue;
+        }
+
+        const uint shortestPathCost =
+            frontCost + frontRoughness + state.getRoughness(nearIndex);
+
+        if(shortestPathCost < state.getCost(nearIndex)) {
+          state.setCost(nearIndex, shortestPathCost);
+          state.setParentDir(nearIndex, nearDir);
+          frontier.push(shortestPathCost, nearPoint);
+        }
+      } else {
+        const uint moveCost = api->getMoveCost(frontPoint, nearDir);
+        const uint nearRoughness = moveCost - frontRoughness;
+        const uint shortestPathCost = moveCost + frontCost;
+
+        state.reach(nearIndex, shortestPathCost, nearRoughness, nearDir);
+        frontier.push(shortestPathCost, nearPoint);
+      }
+    }
+  }
+
+  // Reverse the path from the finish.
+  return state.tracePath(finish);
+}
@@ -0,0 +1,42 @@
+#include "agent/agent-impl.h"
+#include "search/cluster-graph.h"
+#include "search/terrain-cache.h"
+
+using Rally::ClusterGraph;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::TerrainCache;
+
+namespace {
+
+// Kept between races, so every race on the same terrain shares the work of
+// learning the map and building the clusters.
+struct Scratch {
+  TerrainCache terrain;
+  ClusterGraph graph;
+  std::vector<Point> changed;
+
+  void reset() { changed.clear(); }
+};
+
+}  // namespace
+
+// This agent is an implementation of hierarchical pathfinding (HPA*). The
+// whole map is learned once per terrain and split into clusters, and each race
+// searches between the clusters before finding the moves within them. The
+// first race on a terrain is expensive, but every race after it only costs a
+// few map looks. The paths found are close to the cheapest, but not always the
+// cheapest.
+REGISTER_AGENT_WITH_SCRATCH(HPAStar, Scratch)(MapInterface* const api) {
+  if(scratch.terrain.update(api, scratch.changed)) {
+    scratch.graph.build(scratch.terrain);
+  } else if(!scratch.changed.empty()) {
+    scratch.graph.repair(scratch.terrain, scratch.changed);
+  }
+
+  std::vector<Direction::T> path = scratch.graph.findPath(
+      scratch.terrain, api->getStart(), api->getFinish());
+  api->addExpansions(scratch.graph.getExpansions());
+
+  return path;
+}
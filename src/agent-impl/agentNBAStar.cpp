@@ -1,20 +1,17 @@
 #include <algorithm>
 #include <cmath>
-#include <queue>
-#include <set>
-#include <unordered_map>
 
 #include "agent/agent-impl.h"
+#include "search/node-store.h"
+#include "search/reusable-heap.h"
 
 using Rally::MapInterface;
+using Rally::NodeStore;
 using Rally::Point;
 
 namespace {
 
-typedef std::priority_queue<std::pair<uint, Point>,
-                            std::vector<std::pair<uint, Point>>,
-                            std::greater<std::pair<uint, Point>>>
-    FrontierQueue;
+typedef Rally::ReusableHeap<std::pair<uint, Point>> FrontierQueue;
 
 struct PointInfo {
   uint shortestPathCost;
@@ -27,14 +24,28 @@ inline uint hueristic(const Point& a, const Point& b) {
   return a.distanceTo(b) * 2;
 }
 
+struct Scratch {
+  NodeStore<PointInfo> pointMapForwards;
+  NodeStore<PointInfo> pointMapBackwards;
+  // Only whether a point is in `closed` matters, not the value stored.
+  NodeStore<char> closed;
+  FrontierQueue frontierForwards;
+  FrontierQueue frontierBackwards;
+
+  void reset() {
+    frontierForwards.clear();
+    frontierBackwards.clear();
+  }
+};
+
 // A point might be in the frontier multiple times because the cost has been
 // updated, or it might have been moved into the closed set. The pointMap holds
 // the up to date information, so it's simple to clear out the invalid date.
 // Simply clearing off the top of the frontier is preferable to sorting and
 // validating the frontier as points are added.
 void clearFrontierTop(FrontierQueue& frontier,
-                      const std::unordered_map<Point, PointInfo>& pointMap,
-                      const std::set<Point>& closed) {
+                      const NodeStore<PointInfo>& pointMap,
+                      const NodeStore<char>& closed) {
   if(frontier.size() == 0) {
     return;
   }
@@ -43,20 +54,23 @@ void clearFrontierTop(FrontierQueue& frontier,
   const PointInfo* frontInfo = &pointMap.at(frontPoint);
   uint frontCost = frontier.top().first - frontInfo->pathEstimate;
 
-  while(frontier.size() > 0 && (closed.find(frontPoint) != closed.end() ||
+  while(frontier.size() > 0 && (closed.contains(frontPoint) ||
                                 frontCost != frontInfo->shortestPathCost)) {
     frontier.pop();
+    if(frontier.empty()) {
+      break;
+    }
 
     frontPoint = frontier.top().second;
     frontInfo = &pointMap.at(frontPoint);
     frontCost = frontier.top().first - frontInfo->pathEstimate;
-  };
+  }
 }
 
 void expandFrontier(MapInterface* const api,
-                    std::unordered_map<Point, PointInfo>& pointMapA,
-                    const std::unordered_map<Point, PointInfo>& pointMapB,
-                    std::set<Point>& closed,
+                    NodeStore<PointInfo>& pointMapA,
+                    const NodeStore<PointInfo>& pointMapB,
+                    NodeStore<char>& closed,
                     FrontierQueue& frontier,
                     const Point& source,
                     const Point& target,
@@ -73,7 +87,7 @@ void expandFrontier(MapInterface* const api,
   const Point frontPoint = frontier.top().second;
   const PointInfo& frontInfo = pointMapA.at(frontPoint);
 
-  closed.insert(frontPoint);
+  closed.insert(frontPoint, true);
 
   // A point is considered only if the pathEstimated cost to reach the end is
   // less than the known shortest path to reach the end.
@@ -88,8 +102,9 @@ void expandFrontier(MapInterface* const api,
       uint pathCost =
           frontInfo.shortestPathCost + api->getMoveCost(frontPoint, nearDir);
 
-      if(pointMapA.find(nearPoint) != pointMapA.end()) {
-        PointInfo& nearInfo = pointMapA.at(nearPoint);
+      PointInfo* const found = pointMapA.find(nearPoint);
+      if(found != nullptr) {
+        PointInfo& nearInfo = *found;
 
         if(pathCost < nearInfo.shortestPathCost) {
           nearInfo.shortestPathCost = pathCost;
@@ -99,9 +114,10 @@ void expandFrontier(MapInterface* const api,
 
           // Check if the frontiers are touching. If so update the shortest path
           // as needed.
-          if(pointMapB.find(nearPoint) != pointMapB.end()) {
+          const PointInfo* const opposite = pointMapB.find(nearPoint);
+          if(opposite != nullptr) {
             uint combinedCost = nearInfo.shortestPathCost +
-                                pointMapB.at(nearPoint).shortestPathCost;
+                                opposite->shortestPathCost;
 
             if(combinedCost < shortestFullPath) {
               shortestFullPath = combinedCost;
@@ -112,13 +128,13 @@ void expandFrontier(MapInterface* const api,
       } else {
         const uint pathEstimate = hueristic(nearPoint, target);
 
-        pointMapA.insert({nearPoint, PointInfo{pathCost, pathEstimate,
-                                               frontPoint, nearDir}});
+        pointMapA.insert(nearPoint, PointInfo{pathCost, pathEstimate,
+                                              frontPoint, nearDir});
         frontier.push({pathCost + pathEstimate, nearPoint});
 
-        if(pointMapB.find(nearPoint) != pointMapB.end()) {
-          uint combinedCost =
-              pathCost + pointMapB.at(nearPoint).shortestPathCost;
+        const PointInfo* const opposite = pointMapB.find(nearPoint);
+        if(opposite != nullptr) {
+          uint combinedCost = pathCost + opposite->shortestPathCost;
 
           if(combinedCost < shortestFullPath) {
             shortestFullPath = combinedCost;
@@ -143,33 +159,37 @@ The algorithm implemented here is the New Bidirectional A* algorithm (NBA*).
 This algorithm is presented in "Yet another bidirectional algorithm for shortest
 paths" by Wim Pijls and Henk Post.
 */
-REGISTER_AGENT(NBAStar)(MapInterface* const api) {
+REGISTER_AGENT_WITH_SCRATCH(NBAStar, Scratch)(MapInterface* const api) {
   const Point start = api->getStart();
   const Point finish = api->getFinish();
 
-  std::unordered_map<Point, PointInfo> pointMapForwards;
-  pointMapForwards.insert({start, PointInfo{
-                                      0,  // shortestPathCost
-                                      hueristic(start, finish),  // pathEstimate
-                                      {-1, -1},                  // parent
-                                      Direction::T::eNone        // parentDir
-                                  }});
-
-  std::unordered_map<Point, PointInfo> pointMapBackwards;
-  pointMapBackwards.insert(
-      {finish, PointInfo{
-                   0,                         // shortestPathCost
-                   hueristic(finish, start),  // pathEstimate
-                   {-1, -1},                  // parent
-                   Direction::T::eNone        // parentDir
-               }});
-
-  std::set<Point> closed;
-
-  FrontierQueue frontierForwards;
+  NodeStore<PointInfo>& pointMapForwards = scratch.pointMapForwards;
+  NodeStore<PointInfo>& pointMapBackwards = scratch.pointMapBackwards;
+  NodeStore<char>& closed = scratch.closed;
+  pointMapForwards.reset(api->getWidth(), api->getHeight());
+  pointMapBackwards.reset(api->getWidth(), api->getHeight());
+  closed.reset(api->getWidth(), api->getHeight());
+
+  pointMapForwards.insert(start,
+                          PointInfo{
+                              0,                         // shortestPathCost
+                              hueristic(start, finish),  // pathEstimate
+                              {-1, -1},                  // parent
+                              Direction::T::eNone        // parentDir
+                          });
+
+  pointMapBackwards.insert(finish,
+                           PointInfo{
+                               0,                         // shortestPathCost
+                               hueristic(finish, start),  // pathEstimate
+                               {-1, -1},                  // parent
+                               Direction::T::eNone        // parentDir
+                           });
+
+  FrontierQueue& frontierForwards = scratch.frontierForwards;
   frontierForwards.push({hueristic(finish, start), start});
 
-  FrontierQueue frontierBackwards;
+  FrontierQueue& frontierBackwards = scratch.frontierBackwards;
   frontierBackwards.push({hueristic(start, finish), finish});
 
   Point touchPoint = {-1, -1};
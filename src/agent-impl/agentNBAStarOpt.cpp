@@ -1,13 +1,20 @@
 #include <algorithm>
 #include <cmath>
-#include <queue>
-#include <set>
-#include <unordered_map>
 
 #include "agent/agent-impl.h"
-
+#include "search/arena.h"
+#include "search/landmarks.h"
+#include "search/search-state.h"
+#include "search/terrain-cache.h"
+#include "search/two-level-bucket-queue.h"
+
+using Rally::Arena;
+using Rally::LandmarkBound;
+using Rally::Landmarks;
 using Rally::MapInterface;
 using Rally::Point;
+using Rally::SearchState;
+using Rally::TerrainCache;
 
 namespace {
 
@@ -15,227 +22,194 @@ struct FrontierEntry {
   Point pos;
   uint shortestPathCost;
   uint pathEstimate;
+};
 
-  inline bool operator==(const FrontierEntry& rhs) {
-    // At the moment there is no need to check `pathEstimate` as the position
-    // being equal implies they are the same.
-    return this->pos == rhs.pos &&
-           this->shortestPathCost == rhs.shortestPathCost;
-  }
+// With a consistent heuristic the estimated full path cost never grows by more
+// than twice the cost of a single move.
+constexpr uint kMaxEstimateStep = Rally::kMaxRoughness * 4;
 
-  inline bool operator!=(const FrontierEntry& rhs) { return !operator==(rhs); }
+// The frontier is ordered by the estimated full path cost. Ties go to the
+// entry with the smaller path cost so far.
+class FrontierQueue {
+  Rally::TwoLevelBucketQueue<FrontierEntry,
+                             Rally::ArenaAllocator<FrontierEntry>>
+      queue;
 
-  inline bool operator<(const FrontierEntry& rhs) const {
-    if(this->shortestPathCost + this->pathEstimate ==
-       rhs.shortestPathCost + rhs.pathEstimate) {
-      return this->shortestPathCost < rhs.shortestPathCost;
-    }
+ public:
+  explicit FrontierQueue(Arena& arena) : queue(kMaxEstimateStep, arena) {}
 
-    return this->shortestPathCost + this->pathEstimate <
-           rhs.shortestPathCost + rhs.pathEstimate;
-  }
+  inline size_t size() const { return queue.size(); }
+  inline const FrontierEntry& top() { return queue.top(); }
+  inline void pop() { queue.pop(); }
 
-  inline bool operator>(const FrontierEntry& rhs) const {
-    return rhs.operator<(*this);
+  inline void push(const FrontierEntry& entry) {
+    queue.push(entry.shortestPathCost + entry.pathEstimate,
+               entry.shortestPathCost, entry);
   }
+};
 
-  inline bool operator<=(const FrontierEntry& rhs) const {
-    return !operator>(rhs);
-  }
+inline uint hueristic(const Point& a, const uint& aRoughness, const Point& b) {
+  return (a.distanceTo(b) - 1) * 2 + aRoughness + 1;
+}
 
-  inline bool operator>=(const FrontierEntry& rhs) const {
-    return !operator<(rhs);
+// The geometric bound, which only knows how far away the target is.
+struct GeometricBound {
+  Point target;
+
+  inline uint operator()(const Point& pos, uint posRoughness) const {
+    return hueristic(pos, posRoughness, target);
   }
 };
 
-typedef std::priority_queue<FrontierEntry,
-                            std::vector<FrontierEntry>,
-                            std::greater<FrontierEntry>>
-    FrontierQueue;
+// The larger of the geometric bound and the landmark bound. Both are
+// consistent, so the larger one is as well.
+struct ALTBound {
+  GeometricBound geometric;
+  LandmarkBound landmarks;
 
-struct PointInfo {
-  uint roughness;
-  uint shortestPathCost;
-  uint pathEstimate;
-  Point parent;
-  Direction::T parentDir;
+  inline uint operator()(const Point& pos, uint posRoughness) const {
+    return std::max(geometric(pos, posRoughness), landmarks(pos));
+  }
 };
 
-inline uint hueristic(const Point& a, const uint& aRoughness, const Point& b) {
-  return (a.distanceTo(b) - 1) * 2 + aRoughness + 1;
-}
+// The frontiers only last for one race, so they're allocated from the race's
+// arena instead of kept here.
+struct Scratch {
+  SearchState stateForwards;
+  SearchState stateBackwards;
 
-// All points other than the start have another point before them in the path.
-// There is never a lower cost for backtracking, so it's wasted effort to check
-// points that the previous point already checked. This cuts out those extra
-// map looks.
-std::vector<std::pair<Point, Direction::T>> getRelevantNeighbors(
-    Point pos,
-    Direction::T parentDir,
-    MapInterface* const api) {
-  std::vector<Direction::T> directions;
-
-  switch(parentDir) {
-    case Direction::T::eNorth:
-      directions = {Direction::T::eNorthWest, Direction::T::eNorth,
-                    Direction::T::eNorthEast};
-      break;
-    case Direction::T::eNorthEast:
-      directions = {Direction::T::eNorth, Direction::T::eNorthEast,
-                    Direction::T::eSouthEast};
-      break;
-    case Direction::T::eSouthEast:
-      directions = {Direction::T::eNorthEast, Direction::T::eSouthEast,
-                    Direction::T::eSouth};
-      break;
-    case Direction::T::eSouth:
-      directions = {Direction::T::eSouthEast, Direction::T::eSouth,
-                    Direction::T::eSouthWest};
-      break;
-    case Direction::T::eSouthWest:
-      directions = {Direction::T::eSouth, Direction::T::eSouthWest,
-                    Direction::T::eNorthWest};
-      break;
-    case Direction::T::eNorthWest:
-      directions = {Direction::T::eSouthWest, Direction::T::eNorthWest,
-                    Direction::T::eNorth};
-      break;
-    case Direction::T::eNone:
-      directions.assign(Direction::kAllMoveDirections.begin(),
-                        Direction::kAllMoveDirections.end());
-  }
+  void reset() {}
+};
 
-  std::vector<std::pair<Point, Direction::T>> neighbors;
-  neighbors.reserve(3);
-  for(const auto& dir : directions) {
-    const auto near = api->getDestination(pos, dir);
+// Keeps the terrain and landmarks of the last race, so every race on the same
+// terrain shares the work of learning the map and building the tables.
+struct ALTScratch {
+  SearchState stateForwards;
+  SearchState stateBackwards;
+  TerrainCache terrain;
+  Landmarks landmarks;
+  std::vector<Point> changed;
 
-    if(near != pos) {
-      neighbors.push_back({near, dir});
-    }
-  }
+  void reset() { changed.clear(); }
+};
 
-  return neighbors;
+// A point is closed once either search has expanded it.
+inline bool isClosed(const SearchState& stateA,
+                     const SearchState& stateB,
+                     size_t i) {
+  return stateA.isClosed(i) || (stateB.isReached(i) && stateB.isClosed(i));
 }
 
 // A point might be in the frontier multiple times because the cost has been
-// updated, or it might have been moved into the closed set. The pointMap holds
-// the up to date information, so it's simple to clear out the invalid date.
+// updated, or it might have been closed. The search states hold the up to date
+// information, so it's simple to clear out the invalid date.
 // Simply clearing off the top of the frontier is preferable to sorting and
 // validating the frontier as points are added.
 void clearFrontierTop(FrontierQueue& frontier,
-                      const std::unordered_map<Point, PointInfo>& pointMap,
-                      const std::set<Point>& closed) {
-  if(frontier.size() == 0) {
-    return;
-  }
-
-  Point frontPoint = frontier.top().pos;
-  const PointInfo* frontInfo = &pointMap.at(frontPoint);
-  uint frontCost = frontier.top().shortestPathCost;
+                      const SearchState& stateA,
+                      const SearchState& stateB) {
+  while(frontier.size() > 0) {
+    const size_t front = stateA.index(frontier.top().pos);
+
+    if(!isClosed(stateA, stateB, front) &&
+       frontier.top().shortestPathCost == stateA.getCost(front)) {
+      return;
+    }
 
-  while(frontier.size() > 0 && (closed.find(frontPoint) != closed.end() ||
-                                frontCost != frontInfo->shortestPathCost)) {
     frontier.pop();
-
-    frontPoint = frontier.top().pos;
-    frontInfo = &pointMap.at(frontPoint);
-    frontCost = frontier.top().shortestPathCost;
-  };
+  }
 }
 
+// `toSource` and `toTarget` give lower bounds on the cost from a hex to the
+// start of this side's search, and to the start of the other side's.
+template <class Bound>
 void expandFrontier(MapInterface* const api,
-                    std::unordered_map<Point, PointInfo>& pointMapA,
-                    const std::unordered_map<Point, PointInfo>& pointMapB,
-                    std::set<Point>& closed,
+                    SearchState& stateA,
+                    const SearchState& stateB,
                     FrontierQueue& frontier,
-                    const Point& source,
-                    const Point& target,
+                    const Bound& toSource,
+                    const Bound& toTarget,
                     Point& touchPoint,
                     uint& shortestFullPath,
                     uint& shortestPathA,
                     uint shortestPathB) {
-  clearFrontierTop(frontier, pointMapA, closed);
+  clearFrontierTop(frontier, stateA, stateB);
 
   if(frontier.size() == 0) {
     return;
   }
 
-  const Point frontPoint = frontier.top().pos;
-  const PointInfo& frontInfo = pointMapA.at(frontPoint);
+  const FrontierEntry frontEntry = frontier.top();
+  const Point frontPoint = frontEntry.pos;
+  const size_t front = stateA.index(frontPoint);
+  const uint frontCost = frontEntry.shortestPathCost;
+  const uint frontRoughness = stateA.getRoughness(front);
 
-  closed.insert(frontPoint);
+  stateA.close(front);
 
   // A point is considered only if the pathEstimated cost to reach the end is
   // less than the known shortest path to reach the end.
-  if(frontInfo.shortestPathCost + frontInfo.pathEstimate < shortestFullPath &&
-     frontInfo.shortestPathCost + shortestPathB -
-             hueristic(frontPoint, frontInfo.roughness, source) <
+  if(frontCost + frontEntry.pathEstimate < shortestFullPath &&
+     frontCost + shortestPathB - toSource(frontPoint, frontRoughness) <
          shortestFullPath) {
     for(const auto& near :
-        getRelevantNeighbors(frontPoint, frontInfo.parentDir, api)) {
+        api->getRelevantNeighbors(frontPoint, stateA.getParentDir(front))) {
       Point nearPoint = near.first;
       Direction::T nearDir = near.second;
+      const size_t nearIndex = stateA.index(nearPoint);
+
+      uint cost;
+      if(stateA.isReached(nearIndex)) {
+        const uint nearRoughness = stateA.getRoughness(nearIndex);
+        cost = frontCost + frontRoughness + nearRoughness;
 
-      if(pointMapA.find(nearPoint) != pointMapA.end()) {
-        PointInfo& nearInfo = pointMapA.at(nearPoint);
-
-        uint cost = frontInfo.shortestPathCost + frontInfo.roughness +
-                    nearInfo.roughness;
-
-        if(cost < nearInfo.shortestPathCost) {
-          nearInfo.shortestPathCost = cost;
-          nearInfo.parent = frontPoint;
-          nearInfo.parentDir = nearDir;
-          frontier.push({nearPoint, cost, nearInfo.pathEstimate});
-
-          // Check if the frontiers are touching. If so update the shortest
-          // path as needed.
-          if(pointMapB.find(nearPoint) != pointMapB.end()) {
-            uint combinedCost = nearInfo.shortestPathCost +
-                                pointMapB.at(nearPoint).shortestPathCost;
-
-            if(combinedCost < shortestFullPath) {
-              shortestFullPath = combinedCost;
-              touchPoint = nearPoint;
-            }
-          }
+        if(cost >= stateA.getCost(nearIndex)) {
+          continue;
         }
+
+        stateA.setCost(nearIndex, cost);
+        stateA.setParentDir(nearIndex, nearDir);
+        frontier.push({nearPoint, cost, toTarget(nearPoint, nearRoughness)});
       } else {
         const uint moveCost = api->getMoveCost(frontPoint, nearDir);
-        const uint nearRoughness = moveCost - frontInfo.roughness;
-        const uint pathEstimate = hueristic(nearPoint, nearRoughness, target);
-        const uint shortestPathCost = moveCost + frontInfo.shortestPathCost;
-
-        pointMapA.insert(
-            {nearPoint, PointInfo{nearRoughness, shortestPathCost, pathEstimate,
-                                  frontPoint, nearDir}});
-        frontier.push(FrontierEntry{nearPoint, shortestPathCost, pathEstimate});
-
-        if(pointMapB.find(nearPoint) != pointMapB.end()) {
-          uint combinedCost =
-              shortestPathCost + pointMapB.at(nearPoint).shortestPathCost;
-
-          if(combinedCost < shortestFullPath) {
-            shortestFullPath = combinedCost;
-            touchPoint = nearPoint;
-          }
+        const uint nearRoughness = moveCost - frontRoughness;
+        const uint pathEstimate = toTarget(nearPoint, nearRoughness);
+        cost = moveCost + frontCost;
+
+        stateA.reach(nearIndex, cost, nearRoughness, nearDir);
+        frontier.push(FrontierEntry{nearPoint, cost, pathEstimate});
+      }
+
+      // Check if the frontiers are touching. If so update the shortest
+      // path as needed.
+      if(stateB.isReached(nearIndex)) {
+        uint combinedCost = cost + stateB.getCost(nearIndex);
+
+        if(combinedCost < shortestFullPath) {
+          shortestFullPath = combinedCost;
+          touchPoint = nearPoint;
         }
       }
     }
   }
 
   // This clear is technically unneeded, but results in less map looks.
-  clearFrontierTop(frontier, pointMapA, closed);
+  clearFrontierTop(frontier, stateA, stateB);
 
   if(frontier.size() > 0) {
     shortestPathA =
         frontier.top().shortestPathCost + frontier.top().pathEstimate;
   }
 }
-}  // namespace
 
-REGISTER_AGENT(NBAStarOpt)(MapInterface* const api) {
+// Runs NBA* between the start and the finish, with `toStart` and `toFinish`
+// giving lower bounds on the cost from a hex to either end.
+template <class Bound>
+std::vector<Direction::T> findPath(MapInterface* const api,
+                                   SearchState& stateForwards,
+                                   SearchState& stateBackwards,
+                                   const Bound& toStart,
+                                   const Bound& toFinish) {
   const Point start = api->getStart();
   const Point finish = api->getFinish();
 
@@ -246,75 +220,75 @@ REGISTER_AGENT(NBAStarOpt)(MapInterface* const api) {
     }
   }
 
-  std::unordered_map<Point, PointInfo> pointMapForwards;
-  pointMapForwards.insert(
-      {start, PointInfo{
-                  1,                            // roughness
-                  0,                            // shortestPathCost
-                  hueristic(start, 1, finish),  // pathEstimate
-                  {-1, -1},                     // parent
-                  Direction::T::eNone           // parentDir
-              }});
-
-  std::unordered_map<Point, PointInfo> pointMapBackwards;
-  pointMapBackwards.insert(
-      {finish, PointInfo{
-                   1,                            // roughness
-                   0,                            // shortestPathCost
-                   hueristic(finish, 1, start),  // pathEstimate
-                   {-1, -1},                     // parent
-                   Direction::T::eNone           // parentDir
-               }});
-
-  std::set<Point> closed;
-
-  FrontierQueue frontierForwards;
-  frontierForwards.push(FrontierEntry{start, 0, hueristic(finish, 1, start)});
-
-  FrontierQueue frontierBackwards;
-  frontierBackwards.push(FrontierEntry{finish, 0, hueristic(start, 1, finish)});
+  stateForwards.reset(api->getWidth(), api->getHeight());
+  stateBackwards.reset(api->getWidth(), api->getHeight());
+
+  stateForwards.reach(stateForwards.index(start), 0, 1, Direction::T::eNone);
+  stateBackwards.reach(stateBackwards.index(finish), 0, 1,
+                       Direction::T::eNone);
+
+  FrontierQueue frontierForwards(api->getArena());
+  frontierForwards.push(FrontierEntry{start, 0, toFinish(start, 1)});
+
+  FrontierQueue frontierBackwards(api->getArena());
+  frontierBackwards.push(FrontierEntry{finish, 0, toStart(finish, 1)});
 
   Point touchPoint = {-1, -1};
   uint shortestFullPath = ~0;
-  uint shortestPathForwards = pointMapForwards.at(start).pathEstimate;
-  uint shortestPathBackwards = pointMapBackwards.at(finish).pathEstimate;
+  uint shortestPathForwards = toFinish(start, 1);
+  uint shortestPathBackwards = toStart(finish, 1);
 
   while(frontierForwards.size() > 0 && frontierBackwards.size() > 0) {
     if(frontierForwards.size() <= frontierBackwards.size()) {
-      expandFrontier(api, pointMapForwards, pointMapBackwards, closed,
-                     frontierForwards, start, finish, touchPoint,
-                     shortestFullPath, shortestPathForwards,
-                     shortestPathBackwards);
+      expandFrontier(api, stateForwards, stateBackwards, frontierForwards,
+                     toStart, toFinish, touchPoint, shortestFullPath,
+                     shortestPathForwards, shortestPathBackwards);
     } else {
-      expandFrontier(api, pointMapBackwards, pointMapForwards, closed,
-                     frontierBackwards, finish, start, touchPoint,
-                     shortestFullPath, shortestPathBackwards,
-                     shortestPathForwards);
+      expandFrontier(api, stateBackwards, stateForwards, frontierBackwards,
+                     toFinish, toStart, touchPoint, shortestFullPath,
+                     shortestPathBackwards, shortestPathForwards);
     }
   }
 
   // Put together forwards half of the path.
-  std::vector<Direction::T> path;
-  Point tracePoint = touchPoint;
-  Direction::T traceDir;
-
-  while(tracePoint != start) {
-    PointInfo info = pointMapForwards.at(tracePoint);
-    tracePoint = info.parent;
-    traceDir = info.parentDir;
-    path.push_back(traceDir);
-  }
-
-  std::reverse(path.begin(), path.end());
+  std::vector<Direction::T> path = stateForwards.tracePath(touchPoint);
 
   // Put together backwards half of the path.
-  tracePoint = touchPoint;
-  while(tracePoint != finish) {
-    PointInfo info = pointMapBackwards.at(tracePoint);
-    tracePoint = info.parent;
-    traceDir = info.parentDir;
-    path.push_back(Direction::reverse(traceDir));
+  const std::vector<Direction::T> backwards =
+      stateBackwards.tracePath(touchPoint);
+  for(auto dir = backwards.rbegin(); dir != backwards.rend(); ++dir) {
+    path.push_back(Direction::reverse(*dir));
   }
 
   return path;
 }
+
+}  // namespace
+
+REGISTER_AGENT_WITH_SCRATCH(NBAStarOpt, Scratch)(MapInterface* const api) {
+  return findPath(api, scratch.stateForwards, scratch.stateBackwards,
+                  GeometricBound{api->getStart()},
+                  GeometricBound{api->getFinish()});
+}
+
+// The same NBA* with the ALT bound added. The whole map is learned once per
+// terrain to build the landmark tables, which is expensive, but the tighter
+// bound means every race after that expands far fewer hexes.
+REGISTER_AGENT_WITH_SCRATCH(NBAStarOptALT,
+                            ALTScratch)(MapInterface* const api) {
+  if(scratch.terrain.update(api, scratch.changed)) {
+    scratch.landmarks.build(scratch.terrain);
+  }
+
+  const Point start = api->getStart();
+  const Point finish = api->getFinish();
+  const ALTBound toStart{GeometricBound{start},
+                         LandmarkBound(scratch.landmarks, start, start,
+                                       finish)};
+  const ALTBound toFinish{GeometricBound{finish},
+                          LandmarkBound(scratch.landmarks, finish, start,
+                                        finish)};
+
+  return findPath(api, scratch.stateForwards, scratch.stateBackwards, toStart,
+                  toFinish);
+}
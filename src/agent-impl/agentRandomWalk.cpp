@@ -2,6 +2,7 @@
 
 using Rally::MapInterface;
 using Rally::Point;
+using Rally::Random;
 
 namespace {
 constexpr uint MAX_STEPS = 50;
@@ -15,7 +16,7 @@ REGISTER_AGENT(RandomWalk)(MapInterface* const api) {
 
   for(uint i = 0; currentPos != api->getFinish() && i < MAX_STEPS; ++i) {
     auto nearby = api->getNeighbors(currentPos);
-    Direction::T dir = nearby.at(rand() % nearby.size()).second;
+    Direction::T dir = nearby.at(Random::local().below(nearby.size())).second;
     path.push_back(dir);
     currentPos = api->getDestination(currentPos, dir);
   }
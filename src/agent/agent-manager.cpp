@@ -13,6 +13,10 @@ std::shared_ptr<AgentFactoryBase> AgentManager::registerAgent(
   return fact;
 }
 
+size_t AgentManager::getNumAgents() const {
+  return agentFactories.size();
+}
+
 void AgentManager::makeAgents(std::vector<AgentWrapper>& agents) const {
   for(const auto& factory : agentFactories) {
     agents.push_back(
@@ -1,6 +1,11 @@
 
 #include "agent/agent-wrapper.h"
 
+#include <algorithm>
+
+#include "stats/clock.h"
+#include "stats/heap-usage.h"
+
 namespace Rally {
 
 const char* AgentWrapper::getName() const {
@@ -12,26 +17,92 @@ AgentWrapper::AgentWrapper(std::unique_ptr<AgentBase> agent)
       mapLooks(0),
       pathCost(0),
       finishedRace(false),
+      wallNanos(0),
+      cpuNanos(0),
+      allocations(0),
+      allocatedBytes(0),
+      peakHeapBytes(0),
+      bound(0),
 
       totalMapLooks(0),
       totalPathCost(0),
-      racesFinished(0) {}
+      racesFinished(0),
+      totalCpuNanos(0),
+      totalAllocations(0),
+      totalAllocatedBytes(0),
+      maxPeakHeapBytes(0) {}
 
-void AgentWrapper::addRace(const RallyMap& rally) {
-  MapInterface api(rally);
+// The budget every race after this is run with. See `SearchBudget`.
+void AgentWrapper::setBudget(const SearchBudget& nBudget) {
+  budget = nBudget;
+}
+
+// Runs the agent on the race without recording any statistics. Races can
+// be run by a different wrapper than the one that records them.
+RaceResult AgentWrapper::runRace(const RallyMap& rally) {
+  MapInterface api(rally, arena, budget);
+  RaceResult result;
+
+  const uint64_t wallStart = Rally::wallNanos();
+  const uint64_t cpuStart = threadCpuNanos();
+
+  {
+    HeapScope heap;
+    agent->reset();
+    result.path = agent->RunAgent(&api);
+    result.peakHeapBytes = heap.peakBytes();
+    result.allocations = heap.allocations();
+    result.allocatedBytes = heap.allocatedBytes();
+  }
 
-  path = agent->RunAgent(&api);
-  mapLooks = api.getMapLooks();
-  std::tie(pathCost, finishedRace) = rally.analyzePath(path);
+  result.cpuNanos = threadCpuNanos() - cpuStart;
+  result.wallNanos = Rally::wallNanos() - wallStart;
+
+  // Merging the arena's blocks for the next race can allocate a large block,
+  // which isn't part of this race, so it's left out of the timing and the
+  // heap statistics.
+  arena.release();
+  result.mapLooks = api.getMapLooks();
+  result.expansions = api.getExpansions();
+  result.bound = api.getBound();
+  std::tie(result.pathCost, result.finishedRace) =
+      rally.analyzePath(result.path);
+
+  return result;
+}
+
+// Records the result of a race in both the single race and the overall
+// statistics.
+void AgentWrapper::recordRace(RaceResult result) {
+  path = std::move(result.path);
+  mapLooks = result.mapLooks;
+  pathCost = result.pathCost;
+  finishedRace = result.finishedRace;
+  wallNanos = result.wallNanos;
+  cpuNanos = result.cpuNanos;
+  allocations = result.allocations;
+  allocatedBytes = result.allocatedBytes;
+  peakHeapBytes = result.peakHeapBytes;
+  bound = result.bound;
 
   totalMapLooks += mapLooks;
   totalPathCost += pathCost;
+  totalCpuNanos += cpuNanos;
+  totalAllocations += allocations;
+  totalAllocatedBytes += allocatedBytes;
+  maxPeakHeapBytes = std::max(maxPeakHeapBytes, peakHeapBytes);
+  latency.record(wallNanos);
 
   if(finishedRace) {
     racesFinished += 1;
   }
 }
 
+// Runs the agent on the race and records the result.
+void AgentWrapper::addRace(const RallyMap& rally) {
+  recordRace(runRace(rally));
+}
+
 bool AgentWrapper::operatorOrderLastRace(const AgentWrapper& a,
                                          const AgentWrapper& b) {
   if(a.finishedRace != b.finishedRace) {
@@ -0,0 +1,102 @@
+#include "driver/map-corpus.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "map/map-text.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <dirent.h>
+#include <sys/stat.h>
+#define RALLY_HAVE_DIRENT 1
+#endif
+
+namespace Rally {
+
+namespace {
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+  return text.size() >= suffix.size() &&
+         text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool isMapFile(const std::string& name) {
+  return endsWith(name, ".rallymap") || endsWith(name, ".txt");
+}
+
+#ifdef RALLY_HAVE_DIRENT
+bool isDirectory(const std::string& path) {
+  struct stat info;
+  return ::stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+// The map files in the directory, sorted by name.
+std::vector<std::string> listMapFiles(const std::string& path) {
+  DIR* const dir = ::opendir(path.c_str());
+  if(dir == nullptr) {
+    throw std::runtime_error("could not open corpus " + path);
+  }
+
+  std::vector<std::string> names;
+  while(const dirent* entry = ::readdir(dir)) {
+    const std::string name = entry->d_name;
+    if(isMapFile(name) && !isDirectory(path + "/" + name)) {
+      names.push_back(name);
+    }
+  }
+  ::closedir(dir);
+
+  std::sort(names.begin(), names.end());
+  for(auto& name : names) {
+    name = path + "/" + name;
+  }
+
+  return names;
+}
+#else
+bool isDirectory(const std::string&) {
+  return false;
+}
+
+std::vector<std::string> listMapFiles(const std::string&) {
+  throw std::runtime_error("corpus directories aren't supported here");
+}
+#endif
+
+}  // namespace
+
+// Throws an exception if the corpus can't be read, or holds no maps.
+MapCorpus::MapCorpus(const std::string& path,
+                     Encoding encoding,
+                     Layout layout)
+    : encoding(encoding), layout(layout) {
+  if(isDirectory(path)) {
+    files = listMapFiles(path);
+  } else {
+    archive.reset(new MapArchive(path));
+  }
+
+  if(size() == 0) {
+    throw std::invalid_argument("corpus " + path + " holds no maps");
+  }
+}
+
+size_t MapCorpus::size() const {
+  return archive ? archive->size() : files.size();
+}
+
+// Throws an exception if the map can't be read or isn't valid.
+RallyMap MapCorpus::load(size_t i) const {
+  if(archive) {
+    return archive->load(i);
+  }
+
+  const std::string& file = files.at(i);
+  if(endsWith(file, ".txt")) {
+    return loadMapText(file, encoding, layout);
+  }
+
+  return loadMapFile(file);
+}
+
+}  // namespace Rally
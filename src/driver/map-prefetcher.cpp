@@ -0,0 +1,84 @@
+#include "driver/map-prefetcher.h"
+
+#include <algorithm>
+
+namespace Rally {
+
+// Starts loading maps `0` through `count - 1` with `load`.
+MapPrefetcher::MapPrefetcher(size_t count,
+                             size_t depth,
+                             std::function<RallyMap(size_t)> load)
+    : load(std::move(load)),
+      count(count),
+      depth(std::max<size_t>(depth, 1)),
+      numLoaded(0),
+      stopping(false),
+      loader(&MapPrefetcher::work, this) {}
+
+MapPrefetcher::~MapPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  taken.notify_all();
+
+  loader.join();
+}
+
+void MapPrefetcher::work() {
+  for(size_t i = 0; i < count; ++i) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      taken.wait(lock, [this] { return stopping || ready.size() < depth; });
+
+      if(stopping) {
+        return;
+      }
+    }
+
+    // The lock isn't held while loading, so maps can be taken meanwhile.
+    bool failed = false;
+    try {
+      RallyMap map = load(i);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      ready.push_back(std::move(map));
+      numLoaded += 1;
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      error = std::current_exception();
+      failed = true;
+    }
+    loaded.notify_one();
+
+    if(failed) {
+      return;
+    }
+  }
+}
+
+// Waits for the next map and appends it to `maps`. Returns false once every
+// map has been taken. If loading the map threw an exception, it's thrown
+// again here.
+bool MapPrefetcher::next(std::vector<RallyMap>& maps) {
+  std::unique_lock<std::mutex> lock(mutex);
+  loaded.wait(lock, [this] {
+    return !ready.empty() || error || numLoaded == count;
+  });
+
+  if(!ready.empty()) {
+    maps.push_back(std::move(ready.front()));
+    ready.pop_front();
+    lock.unlock();
+    taken.notify_one();
+    return true;
+  }
+
+  if(error) {
+    std::rethrow_exception(error);
+  }
+
+  return false;
+}
+
+}  // namespace Rally
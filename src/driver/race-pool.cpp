@@ -0,0 +1,96 @@
+#include "driver/race-pool.h"
+
+#include "agent/agent-manager.h"
+
+namespace Rally {
+
+RacePool::RacePool(uint numThreads, const SearchBudget& budget)
+    : numAgents(AgentManager::GetInstance()->getNumAgents()),
+      budget(budget),
+      maps(nullptr),
+      results(nullptr),
+      numTasks(0),
+      nextTask(0),
+      batch(0),
+      busyWorkers(0),
+      stopping(false) {
+  for(uint i = 0; i < numThreads; ++i) {
+    workers.push_back(std::thread(&RacePool::work, this));
+  }
+}
+
+RacePool::~RacePool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  batchReady.notify_all();
+
+  for(auto& worker : workers) {
+    worker.join();
+  }
+}
+
+uint RacePool::getNumThreads() const {
+  return workers.size();
+}
+
+// Runs every agent on each of the maps, and blocks until they're all done.
+// `results[race][agent]` is the result of the agent, in registration order,
+// on `maps[race]`.
+void RacePool::runRaces(const std::vector<RallyMap>& maps,
+                        std::vector<std::vector<RaceResult>>& results) {
+  results.assign(maps.size(), std::vector<RaceResult>(numAgents));
+
+  std::unique_lock<std::mutex> lock(mutex);
+  this->maps = &maps;
+  this->results = &results;
+  numTasks = maps.size() * numAgents;
+  nextTask = 0;
+  busyWorkers = workers.size();
+  ++batch;
+  batchReady.notify_all();
+
+  // Waiting on every worker, and not just every task, guarantees no worker is
+  // still looking at the task counter when the next batch starts.
+  batchDone.wait(lock, [this] { return busyWorkers == 0; });
+
+  this->maps = nullptr;
+  this->results = nullptr;
+}
+
+void RacePool::work() {
+  std::vector<AgentWrapper> agents;
+  AgentManager::GetInstance()->makeAgents(agents);
+  for(AgentWrapper& agent : agents) {
+    agent.setBudget(budget);
+  }
+
+  uint seenBatch = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while(true) {
+    batchReady.wait(lock, [&] { return stopping || batch != seenBatch; });
+
+    if(stopping) {
+      return;
+    }
+
+    seenBatch = batch;
+    lock.unlock();
+
+    for(size_t task = nextTask++; task < numTasks; task = nextTask++) {
+      const size_t race = task / numAgents;
+      const size_t agent = task % numAgents;
+
+      (*results)[race][agent] = agents[agent].runRace((*maps)[race]);
+    }
+
+    lock.lock();
+    if(--busyWorkers == 0) {
+      batchDone.notify_one();
+    }
+  }
+}
+
+}  // namespace Rally
@@ -0,0 +1,171 @@
+#include "driver/record-writer.h"
+
+#include <cstdio>
+
+namespace Rally {
+
+namespace {
+
+// The buffer is handed to the stream once it grows past this many bytes.
+constexpr size_t kFlushBytes = 64 * 1024;
+
+// The fields of every record, in order.
+constexpr const char* kFields[] = {
+    "race",
+    "width",
+    "height",
+    "agent",
+    "path_cost",
+    "finished",
+    "map_looks",
+    "expansions",
+    "path_length",
+    "wall_ns",
+    "cpu_ns",
+    "peak_heap_bytes",
+    "allocations",
+    "allocated_bytes",
+    "bound",
+};
+constexpr size_t kNumFields = sizeof(kFields) / sizeof(kFields[0]);
+constexpr size_t kAgentField = 3;
+
+// Agent names are plain identifiers, but quotes and control characters are
+// escaped anyway so a record can never be malformed.
+void appendJsonString(std::string& buffer, const char* text) {
+  buffer += '"';
+  for(; *text != '\0'; ++text) {
+    const char c = *text;
+    if(c == '"' || c == '\\') {
+      buffer += '\\';
+      buffer += c;
+    } else if(static_cast<unsigned char>(c) < 0x20) {
+      static const char kHex[] = "0123456789abcdef";
+      buffer += "\\u00";
+      buffer += kHex[c >> 4];
+      buffer += kHex[c & 0xf];
+    } else {
+      buffer += c;
+    }
+  }
+  buffer += '"';
+}
+
+void appendCsvString(std::string& buffer, const char* text) {
+  const std::string value = text;
+  if(value.find_first_of(",\"\n") == std::string::npos) {
+    buffer += value;
+    return;
+  }
+
+  buffer += '"';
+  for(const char c : value) {
+    if(c == '"') {
+      buffer += '"';
+    }
+    buffer += c;
+  }
+  buffer += '"';
+}
+
+// The bound is written with as few digits as it needs, so a bound of one is
+// written as "1" rather than "1.000000".
+std::string formatBound(double bound) {
+  char text[32];
+  std::snprintf(text, sizeof(text), "%.6g", bound);
+  return text;
+}
+
+}  // namespace
+
+const char* recordFormatName(RecordFormat format) {
+  switch(format) {
+    case RecordFormat::eCsv:
+      return "csv";
+    case RecordFormat::eJsonLines:
+      return "jsonl";
+  }
+
+  return "unknown";
+}
+
+RecordWriter::RecordWriter(std::ostream& out, RecordFormat format)
+    : out(out), format(format), wroteHeader(false) {
+  buffer.reserve(kFlushBytes * 2);
+}
+
+RecordWriter::~RecordWriter() {
+  flush();
+}
+
+void RecordWriter::write(uint race,
+                         const RallyMap& map,
+                         const char* agentName,
+                         const RaceResult& result) {
+  // Every field but the agent's name is written as is.
+  const std::string values[kNumFields] = {
+      std::to_string(race),
+      std::to_string(map.getWidth()),
+      std::to_string(map.getHeight()),
+      "",
+      std::to_string(result.pathCost),
+      result.finishedRace ? "true" : "false",
+      std::to_string(result.mapLooks),
+      std::to_string(result.expansions),
+      std::to_string(result.path.size()),
+      std::to_string(result.wallNanos),
+      std::to_string(result.cpuNanos),
+      std::to_string(result.peakHeapBytes),
+      std::to_string(result.allocations),
+      std::to_string(result.allocatedBytes),
+      formatBound(result.bound),
+  };
+
+  if(format == RecordFormat::eCsv) {
+    if(!wroteHeader) {
+      for(size_t i = 0; i < kNumFields; ++i) {
+        buffer += i == 0 ? "" : ",";
+        buffer += kFields[i];
+      }
+      buffer += '\n';
+      wroteHeader = true;
+    }
+
+    for(size_t i = 0; i < kNumFields; ++i) {
+      buffer += i == 0 ? "" : ",";
+      if(i == kAgentField) {
+        appendCsvString(buffer, agentName);
+      } else {
+        buffer += values[i];
+      }
+    }
+    buffer += '\n';
+  } else {
+    buffer += '{';
+    for(size_t i = 0; i < kNumFields; ++i) {
+      buffer += i == 0 ? "\"" : ",\"";
+      buffer += kFields[i];
+      buffer += "\":";
+      if(i == kAgentField) {
+        appendJsonString(buffer, agentName);
+      } else {
+        buffer += values[i];
+      }
+    }
+    buffer += "}\n";
+  }
+
+  if(buffer.size() >= kFlushBytes) {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+  }
+}
+
+// Hands everything buffered so far to the stream, and flushes it.
+void RecordWriter::flush() {
+  out.write(buffer.data(), buffer.size());
+  out.flush();
+  buffer.clear();
+}
+
+}  // namespace Rally
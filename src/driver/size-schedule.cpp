@@ -0,0 +1,117 @@
+#include "driver/size-schedule.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace Rally {
+
+namespace {
+
+std::vector<std::string> split(const std::string& text, char separator) {
+  std::vector<std::string> parts;
+  std::istringstream in(text);
+  std::string part;
+
+  while(std::getline(in, part, separator)) {
+    parts.push_back(part);
+  }
+
+  // `getline` drops a trailing empty part, which should still be an error.
+  if(!text.empty() && text.back() == separator) {
+    parts.push_back("");
+  }
+
+  return parts;
+}
+
+// Only plain digits are accepted, so signs and trailing junk are errors.
+bool parseNumber(const std::string& text, uint& number) {
+  if(text.empty() || text.size() > 9 ||
+     text.find_first_not_of("0123456789") != std::string::npos) {
+    return false;
+  }
+
+  number = std::stoul(text, nullptr, 10);
+  return true;
+}
+
+bool parseSize(const std::string& text, uint& size) {
+  return parseNumber(text, size) && size >= kMinSweepSize &&
+         size <= kMaxSweepSize;
+}
+
+bool parseRatio(const std::string& text, double& ratio) {
+  try {
+    size_t end;
+    ratio = std::stod(text, &end);
+    return end == text.size() && ratio > 1 && std::isfinite(ratio);
+  } catch(std::logic_error& e) {
+    return false;
+  }
+}
+
+}  // namespace
+
+bool parseSizeSchedule(const std::string& schedule, std::vector<uint>& sizes) {
+  const std::vector<std::string> parts = split(schedule, ':');
+  std::vector<uint> result;
+
+  if(parts.size() == 2 && parts[0] == "list") {
+    for(const auto& text : split(parts[1], ',')) {
+      uint size;
+      if(!parseSize(text, size)) {
+        return false;
+      }
+
+      result.push_back(size);
+    }
+  } else if(parts.size() == 4 &&
+            (parts[0] == "linear" || parts[0] == "geometric")) {
+    uint min;
+    uint max;
+    if(!parseSize(parts[1], min) || !parseSize(parts[2], max) || min > max) {
+      return false;
+    }
+
+    if(parts[0] == "linear") {
+      uint step;
+      if(!parseNumber(parts[3], step) || step == 0) {
+        return false;
+      }
+
+      for(uint size = min; size < max; size += step) {
+        result.push_back(size);
+      }
+    } else {
+      double ratio;
+      if(!parseRatio(parts[3], ratio)) {
+        return false;
+      }
+
+      // Rounding can land a small ratio on the same size twice, so the size
+      // always moves up by at least one.
+      for(double size = min; size < max;) {
+        result.push_back(static_cast<uint>(size));
+        size = std::max(std::round(size * ratio), size + 1);
+      }
+    }
+
+    result.push_back(max);
+  } else {
+    return false;
+  }
+
+  if(result.empty()) {
+    return false;
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+
+  sizes = std::move(result);
+  return true;
+}
+
+}  // namespace Rally
@@ -1,11 +1,24 @@
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
-#include <ctime>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
 
 #include "agent/agent-manager.h"
+#include "driver/map-corpus.h"
+#include "driver/map-prefetcher.h"
+#include "driver/race-pool.h"
+#include "driver/record-writer.h"
+#include "driver/size-schedule.h"
+#include "map/map-file.h"
 #include "map/rally-map.h"
+#include "stats/heap-usage.h"
 
 namespace {
 // So a larger number of cases are covered the size of the `RallyMap` changes
@@ -17,11 +30,30 @@ const int kMinMapWidth = 3;
 const int kMinMapHeigh = 3;
 const int kMaxMapWidth = 28;
 const int kMaxMapHeight = 28;
+
+// When running races in parallel they're handed out in batches, so the results
+// can be printed in order without holding every race in memory.
+const uint kRacesPerThread = 16;
+
+// A sweep runs fewer races per size by default, since its maps can be huge.
+// Its batches are also cut down so the maps in a batch fit in this many bytes.
+const int kDefaultSweepRaces = 10;
+const size_t kSweepBatchBytes = size_t(1) << 30;
 }  // namespace
 
 using Rally::AgentManager;
 using Rally::AgentWrapper;
+using Rally::Encoding;
+using Rally::Layout;
+using Rally::MapCorpus;
+using Rally::MapPrefetcher;
+using Rally::RacePool;
+using Rally::RaceResult;
 using Rally::RallyMap;
+using Rally::Random;
+using Rally::RecordFormat;
+using Rally::RecordWriter;
+using Rally::heapStatsEnabled;
 
 namespace {
 
@@ -67,86 +99,614 @@ std::string printPath(std::vector<Direction::T> path) {
   return out;
 }
 
+// Formats nanoseconds as microseconds or milliseconds with one decimal place.
+std::string formatMicros(uint64_t nanos) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1) << nanos / 1000.0;
+  return out.str();
+}
+
+std::string formatMillis(uint64_t nanos) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1) << nanos / 1000000.0;
+  return out.str();
+}
+
+// Prints the allocation columns that follow the map looks with
+// `--alloc-stats`.
+void printAllocStats(uint64_t allocations,
+                     uint64_t allocatedBytes,
+                     int64_t peakBytes) {
+  std::cout << std::right << std::setw(9) << allocations << " | ";
+  std::cout << std::right << std::setw(11) << (allocatedBytes + 1023) / 1024
+            << " | ";
+  std::cout << std::right << std::setw(10) << (peakBytes + 1023) / 1024
+            << " | ";
+}
+
+const char* const kAllocStatsHeader = "    Allocs | Alloc (KiB) | Peak (KiB) |";
+
+bool parseEncoding(const std::string& name, Encoding& encoding) {
+  for(const auto& option :
+      {Encoding::eWide, Encoding::eByte, Encoding::eNibble}) {
+    if(name == Rally::encodingName(option)) {
+      encoding = option;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool parseLayout(const std::string& name, Layout& layout) {
+  if(name == "dense") {
+    layout = Layout::eDense;
+  } else if(name == "padded") {
+    layout = Layout::ePadded;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+bool parseRecordFormat(const std::string& name, RecordFormat& format) {
+  for(const auto& option : {RecordFormat::eCsv, RecordFormat::eJsonLines}) {
+    if(name == Rally::recordFormatName(option)) {
+      format = option;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Accepts a positive number of threads, or 0 to use one thread per core.
+bool parseThreads(const std::string& arg, uint& numThreads) {
+  try {
+    const int tmp = std::stoi(arg, nullptr, 10);
+
+    if(tmp < 0) {
+      return false;
+    }
+
+    numThreads = tmp;
+  } catch(std::logic_error& e) {
+    return false;
+  }
+
+  if(numThreads == 0) {
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  return true;
+}
+
+// Prints how much memory the roughness of a map takes up with each
+// `Encoding`, so that the encodings can be compared.
+void printMemoryReport() {
+  const uint sizes[] = {kMaxMapWidth, 256, 1024, 4096, 16384};
+  const Encoding encodings[] = {Encoding::eWide, Encoding::eByte,
+                                Encoding::eNibble};
+
+  std::cout << "       Map Size";
+  for(const auto& encoding : encodings) {
+    std::cout << " | " << std::right << std::setw(12)
+              << Rally::encodingName(encoding);
+  }
+  std::cout << "\n";
+
+  for(const auto& size : sizes) {
+    std::cout << std::right << std::setw(15)
+              << (std::to_string(size) + "x" + std::to_string(size));
+
+    for(const auto& encoding : encodings) {
+      const size_t bytes = RallyMap::memoryFootprint(encoding, size, size);
+      std::cout << " | " << std::right << std::setw(8) << (bytes + 1023) / 1024
+                << " KiB";
+    }
+    std::cout << "\n";
+  }
+}
+
+// The totals for one agent over every race on maps of one size.
+struct SweepTotals {
+  uint races = 0;
+  uint finished = 0;
+  uint64_t expansions = 0;
+  uint64_t wallNanos = 0;
+  int64_t peakHeapBytes = 0;
+};
+
+// Formats a count per second of the given nanoseconds with two decimal places,
+// since only a fraction of a race may finish per second on large maps.
+std::string formatRate(uint64_t count, uint64_t nanos) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(2)
+      << (nanos == 0 ? 0.0 : count * 1e9 / nanos);
+  return out.str();
+}
+
+// Runs `racesPerSize` races on square maps of each size, and prints how the
+// throughput and memory use of each agent change as the maps grow. Rates are
+// taken over the time spent in the agents only, so making the maps doesn't
+// count against them. The peak is the most heap memory an agent allocated
+// during any one race, which includes any state it keeps between races
+// growing to fit the map, and is left out unless the build counts heap usage.
+// The sizes should be in increasing order, otherwise that growth is missed.
+//
+// If there's a `writer` every race is written to it instead, and the totals
+// aren't printed.
+void runSweep(const std::vector<uint>& sizes,
+              uint racesPerSize,
+              Encoding encoding,
+              Layout layout,
+              uint64_t seed,
+              std::vector<AgentWrapper>& wrappers,
+              RacePool* pool,
+              RecordWriter* writer) {
+  if(!writer) {
+    std::cout << "  Map Size |             Name |    Races/s | Expansions/s |"
+              << "   Peak (KiB) | Finished" << std::endl;
+  }
+
+  std::vector<RallyMap> maps;
+  std::vector<std::vector<RaceResult>> results;
+  uint race = 0;
+
+  for(const uint size : sizes) {
+    const size_t mapBytes = RallyMap::memoryFootprint(encoding, size, size,
+                                                      layout);
+    const size_t maxBatch = pool ? pool->getNumThreads() * kRacesPerThread : 1;
+    const size_t batchSize =
+        std::max<size_t>(1, std::min(maxBatch, kSweepBatchBytes / mapBytes));
+
+    std::vector<SweepTotals> totals(wrappers.size());
+
+    for(uint sizeRace = 0; sizeRace < racesPerSize;) {
+      const uint firstRace = race;
+      maps.clear();
+      for(; maps.size() < batchSize && sizeRace < racesPerSize;
+          ++sizeRace, ++race) {
+        Random random(Random::deriveSeed(seed, race));
+        maps.push_back(RallyMap(size, size, random, encoding, layout));
+      }
+
+      if(pool) {
+        pool->runRaces(maps, results);
+      } else {
+        results.assign(maps.size(), std::vector<RaceResult>());
+        for(size_t i = 0; i < maps.size(); ++i) {
+          for(AgentWrapper& agent : wrappers) {
+            results[i].push_back(agent.runRace(maps[i]));
+          }
+        }
+      }
+
+      for(size_t i = 0; i < results.size(); ++i) {
+        for(size_t agent = 0; agent < wrappers.size(); ++agent) {
+          const RaceResult& result = results[i][agent];
+          SweepTotals& total = totals[agent];
+
+          if(writer) {
+            writer->write(firstRace + i, maps[i], wrappers[agent].getName(),
+                          result);
+          }
+
+          total.races += 1;
+          total.finished += result.finishedRace ? 1 : 0;
+          total.expansions += result.expansions;
+          total.wallNanos += result.wallNanos;
+          total.peakHeapBytes =
+              std::max(total.peakHeapBytes, result.peakHeapBytes);
+        }
+      }
+    }
+
+    if(writer) {
+      writer->flush();
+      continue;
+    }
+
+    const std::string sizeName =
+        std::to_string(size) + "x" + std::to_string(size);
+
+    for(size_t agent = 0; agent < wrappers.size(); ++agent) {
+      const SweepTotals& total = totals[agent];
+
+      std::cout << std::right << std::setw(10) << sizeName << " | ";
+      std::cout << std::right << std::setw(16) << wrappers[agent].getName()
+                << " | ";
+      std::cout << std::right << std::setw(10)
+                << formatRate(total.races, total.wallNanos) << " | ";
+      std::cout << std::right << std::setw(12)
+                << formatRate(total.expansions, total.wallNanos) << " | ";
+      if(heapStatsEnabled()) {
+        std::cout << std::right << std::setw(12)
+                  << (total.peakHeapBytes + 1023) / 1024 << " | ";
+      } else {
+        std::cout << std::right << std::setw(12) << "-" << " | ";
+      }
+      std::cout << std::right << std::setw(8) << total.finished << "\n";
+    }
+
+    // Each size is printed as soon as it's done, since large ones are slow.
+    std::cout << std::endl;
+  }
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
-  srand(time(NULL));
-
   uint numRaces = kDefaultNumRaces;
+  bool numRacesGiven = false;
+  std::vector<uint> sweepSizes;
+  Encoding encoding = Rally::kDefaultEncoding;
+  Layout layout = Rally::kDefaultLayout;
+  uint numThreads = 1;
+  Rally::SearchBudget budget;
+  uint64_t seed = Random::randomSeed();
+  std::unique_ptr<RecordWriter> writer;
+  bool quiet = false;
+  bool allocStats = false;
+  std::string corpusPath;
+  std::ofstream corpusOut;
 
-  if(argc > 1) {
-    try {
-      int tmp = std::stoi(argv[1], nullptr, 10);
+  // Nothing is read from stdin, so output doesn't need to be kept in step
+  // with it.
+  std::ios::sync_with_stdio(false);
+
+  for(int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
 
-      if(tmp < 0) {
-        std::cerr << "Invalid race count: " << argv[1] << std::endl;
+    if(arg == "--memory-report") {
+      printMemoryReport();
+      return EXIT_SUCCESS;
+    } else if(arg == "--budget-ms") {
+      try {
+        if(i + 1 >= argc) {
+          throw std::invalid_argument("missing budget");
+        }
+
+        const double millis = std::stod(argv[i + 1]);
+        if(!(millis >= 0)) {
+          throw std::invalid_argument("negative budget");
+        }
+
+        // UINT64_MAX rounds up to 2^64 as a double, so any budget that
+        // reaches it doesn't fit in the nanoseconds.
+        if(!std::isfinite(millis) ||
+           millis * 1e6 >= static_cast<double>(UINT64_MAX)) {
+          throw std::out_of_range("budget too large");
+        }
+
+        budget.maxNanos = static_cast<uint64_t>(millis * 1e6);
+      } catch(std::logic_error& e) {
+        std::cerr << "Expected a number of milliseconds after --budget-ms"
+                  << std::endl;
         return EXIT_FAILURE;
       }
 
-      numRaces = tmp;
+      ++i;
+    } else if(arg == "--budget-expansions") {
+      try {
+        if(i + 1 >= argc) {
+          throw std::invalid_argument("missing budget");
+        }
 
-    } catch(std::invalid_argument& e) {
-      std::cerr << "Invalid race count: " << argv[1] << std::endl;
+        const unsigned long expansions = std::stoul(argv[i + 1], nullptr, 10);
+        if(expansions > UINT32_MAX || argv[i + 1][0] == '-') {
+          throw std::out_of_range("budget too large");
+        }
+
+        budget.maxExpansions = static_cast<uint>(expansions);
+      } catch(std::logic_error& e) {
+        std::cerr << "Expected a number of expansions after --budget-expansions"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      ++i;
+    } else if(arg == "--corpus") {
+      if(i + 1 >= argc) {
+        std::cerr << "Expected a directory or archive after --corpus"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      corpusPath = argv[++i];
+    } else if(arg == "--write-corpus") {
+      if(i + 1 >= argc) {
+        std::cerr << "Expected a file after --write-corpus" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      corpusOut.open(argv[++i], std::ios::binary | std::ios::trunc);
+      if(!corpusOut) {
+        std::cerr << "Could not create " << argv[i] << std::endl;
+        return EXIT_FAILURE;
+      }
+    } else if(arg == "--encoding") {
+      if(i + 1 >= argc || !parseEncoding(argv[i + 1], encoding)) {
+        std::cerr << "Expected one of wide, byte, or nibble after --encoding"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      ++i;
+    } else if(arg == "--format") {
+      RecordFormat format;
+      if(i + 1 >= argc || !parseRecordFormat(argv[i + 1], format)) {
+        std::cerr << "Expected one of csv or jsonl after --format" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      writer.reset(new RecordWriter(std::cout, format));
+      ++i;
+    } else if(arg == "--quiet") {
+      quiet = true;
+    } else if(arg == "--alloc-stats") {
+      if(!heapStatsEnabled()) {
+        std::cerr << "--alloc-stats needs a build configured with "
+                  << "-DHEAP_STATS=ON" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      allocStats = true;
+    } else if(arg == "--layout") {
+      if(i + 1 >= argc || !parseLayout(argv[i + 1], layout)) {
+        std::cerr << "Expected one of dense or padded after --layout"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      ++i;
+    } else if(arg == "--seed") {
+      try {
+        if(i + 1 >= argc) {
+          throw std::invalid_argument("missing seed");
+        }
+
+        seed = std::stoull(argv[i + 1], nullptr, 10);
+      } catch(std::logic_error& e) {
+        std::cerr << "Expected a number after --seed" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      ++i;
+    } else if(arg == "--sweep") {
+      if(i + 1 >= argc || !Rally::parseSizeSchedule(argv[i + 1], sweepSizes)) {
+        std::cerr << "Expected a size schedule after --sweep, like "
+                  << "linear:8:64:8, geometric:8:16384:2, or list:8,64,512"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      ++i;
+    } else if(arg == "--threads") {
+      if(i + 1 >= argc || !parseThreads(argv[i + 1], numThreads)) {
+        std::cerr << "Expected a thread count after --threads" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      ++i;
+    } else {
+      try {
+        int tmp = std::stoi(arg, nullptr, 10);
+
+        if(tmp < 0) {
+          std::cerr << "Invalid race count: " << arg << std::endl;
+          return EXIT_FAILURE;
+        }
+
+        numRaces = tmp;
+        numRacesGiven = true;
+
+      } catch(std::invalid_argument& e) {
+        std::cerr << "Invalid race count: " << arg << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  if(!sweepSizes.empty() && !numRacesGiven) {
+    numRaces = kDefaultSweepRaces;
+  }
+
+  if(!sweepSizes.empty() && (!corpusPath.empty() || corpusOut.is_open())) {
+    std::cerr << "--sweep can't be used with a corpus" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::unique_ptr<MapCorpus> corpus;
+  if(!corpusPath.empty()) {
+    try {
+      corpus.reset(new MapCorpus(corpusPath, encoding, layout));
+    } catch(std::exception& e) {
+      std::cerr << e.what() << std::endl;
       return EXIT_FAILURE;
     }
+
+    // Every map in the corpus is raced once unless fewer races are asked for.
+    if(!numRacesGiven || numRaces > corpus->size()) {
+      numRaces = corpus->size();
+    }
+  }
+
+  // Records are the only thing written to stdout, so they can be piped
+  // straight into other tools.
+  std::ostream& info = writer ? std::cerr : std::cout;
+  if(corpus) {
+    info << "Corpus: " << corpusPath << "\n" << std::endl;
+  } else {
+    info << "Seed: " << seed << "\n" << std::endl;
   }
 
   std::vector<AgentWrapper> wrappers;
   AgentManager::GetInstance()->makeAgents(wrappers);
+  for(AgentWrapper& agent : wrappers) {
+    agent.setBudget(budget);
+  }
+
+  // The wrappers stay in registration order to match the race results, and
+  // the rankings are sorted instead. The rankings are sorted in place after
+  // every race, so ties are broken the same no matter how the races were run.
+  std::vector<AgentWrapper*> rankings;
+  for(AgentWrapper& agent : wrappers) {
+    rankings.push_back(&agent);
+  }
+
+  std::unique_ptr<RacePool> pool;
+  if(numThreads > 1) {
+    pool.reset(new RacePool(numThreads, budget));
+  }
+
+  if(!sweepSizes.empty()) {
+    runSweep(sweepSizes, numRaces, encoding, layout, seed, wrappers,
+             pool.get(), writer.get());
+    return EXIT_SUCCESS;
+  }
+
+  const size_t batchSize = pool ? numThreads * kRacesPerThread : 1;
+  const uint numWidths = kMaxMapWidth - kMinMapWidth + 1;
+  const uint numHeights = kMaxMapHeight - kMinMapHeigh + 1;
+
+  std::vector<RallyMap> maps;
+  std::vector<std::vector<RaceResult>> results;
+
+  // Corpus maps are loaded ahead of time while the current batch is raced.
+  // Two batches are kept ready, so loading only stalls the races if it's
+  // slower than racing.
+  std::unique_ptr<MapPrefetcher> prefetcher;
+  if(corpus) {
+    const MapCorpus* const source = corpus.get();
+    prefetcher.reset(new MapPrefetcher(
+        numRaces, batchSize * 2,
+        [source](size_t i) { return source->load(i); }));
+  }
 
   uint race = 0;
-  while(true) {
-    for(uint y = kMinMapHeigh; y <= kMaxMapHeight; ++y) {
-      for(uint x = kMinMapWidth; x <= kMaxMapWidth; ++x) {
-        if(++race > numRaces) {
-          goto endRaces;
+  while(race < numRaces) {
+    // Every race has its own generator, so a race only depends on the seed
+    // and the race number.
+    const uint firstRace = race;
+    maps.clear();
+    for(; maps.size() < batchSize && race < numRaces; ++race) {
+      if(prefetcher) {
+        try {
+          prefetcher->next(maps);
+        } catch(std::exception& e) {
+          std::cerr << e.what() << std::endl;
+          return EXIT_FAILURE;
         }
-        RallyMap rally(x, y);
+      } else {
+        const uint x = kMinMapWidth + race % numWidths;
+        const uint y = kMinMapHeigh + race / numWidths % numHeights;
+        Random random(Random::deriveSeed(seed, race));
+        maps.push_back(RallyMap(x, y, random, encoding, layout));
+      }
 
-        std::cout << rally << std::endl;
+      if(corpusOut.is_open()) {
+        Rally::writeMapFile(corpusOut, maps.back());
+      }
+    }
 
+    if(pool) {
+      pool->runRaces(maps, results);
+    } else {
+      results.assign(maps.size(), std::vector<RaceResult>());
+      for(size_t i = 0; i < maps.size(); ++i) {
         for(AgentWrapper& agent : wrappers) {
-          agent.addRace(rally);
+          results[i].push_back(agent.runRace(maps[i]));
         }
+      }
+    }
 
-        std::sort(wrappers.begin(), wrappers.end(),
-                  AgentWrapper::operatorOrderLastRace);
+    for(size_t i = 0; i < maps.size(); ++i) {
+      if(writer) {
+        for(size_t agent = 0; agent < wrappers.size(); ++agent) {
+          writer->write(firstRace + i, maps[i], wrappers[agent].getName(),
+                        results[i][agent]);
+        }
+        continue;
+      }
 
-        std::cout
-            << "            Name |  Path Cost |  Map Looks | Finished | Path"
-            << std::endl;
+      if(!quiet) {
+        std::cout << maps[i] << "\n";
+      }
 
-        for(const AgentWrapper& agent : wrappers) {
-          std::cout << std::right << std::setw(16) << agent.getName() << " | ";
-          std::cout << std::right << std::setw(10) << agent.pathCost << " | ";
-          std::cout << std::right << std::setw(10) << agent.mapLooks << " | ";
-          std::cout << std::right << std::setw(8)
-                    << (agent.finishedRace ? "Yes" : "No") << " | ";
-          std::cout << printPath(agent.path) << std::endl;
-        }
+      for(size_t agent = 0; agent < wrappers.size(); ++agent) {
+        wrappers[agent].recordRace(std::move(results[i][agent]));
+      }
 
-        std::cout << std::endl;
+      std::sort(rankings.begin(), rankings.end(),
+                [](const AgentWrapper* a, const AgentWrapper* b) {
+                  return AgentWrapper::operatorOrderLastRace(*a, *b);
+                });
+
+      std::cout << "            Name |  Path Cost |  Map Looks |"
+                << (allocStats ? kAllocStatsHeader : "")
+                << " Finished |  Time (us) | Path\n";
+
+      for(const AgentWrapper* agent : rankings) {
+        std::cout << std::right << std::setw(16) << agent->getName() << " | ";
+        std::cout << std::right << std::setw(10) << agent->pathCost << " | ";
+        std::cout << std::right << std::setw(10) << agent->mapLooks << " | ";
+        if(allocStats) {
+          printAllocStats(agent->allocations, agent->allocatedBytes,
+                          agent->peakHeapBytes);
+        }
+        std::cout << std::right << std::setw(8)
+                  << (agent->finishedRace ? "Yes" : "No") << " | ";
+        std::cout << std::right << std::setw(10)
+                  << formatMicros(agent->wallNanos) << " | ";
+        std::cout << printPath(agent->path) << "\n";
       }
+
+      std::cout << "\n";
     }
   }
-endRaces:
 
-  std::sort(wrappers.begin(), wrappers.end(),
-            AgentWrapper::operatorOrderAllRace);
+  // Records are written as the races finish, and there's nothing to rank.
+  if(writer) {
+    return EXIT_SUCCESS;
+  }
+
+  std::sort(rankings.begin(), rankings.end(),
+            [](const AgentWrapper* a, const AgentWrapper* b) {
+              return AgentWrapper::operatorOrderAllRace(*a, *b);
+            });
 
   std::cout << std::endl;
   std::cout << std::string(80, '-') << "\n";
   std::cout << std::string(32, '-') << " Final Rankings "
             << std::string(32, '-') << "\n";
   std::cout << std::string(80, '-') << "\n";
-  std::cout << "            Name |  Path Cost |  Map Looks | Finished"
+  std::cout << "            Name |  Path Cost |  Map Looks |"
+            << (allocStats ? kAllocStatsHeader : "")
+            << " Finished |   CPU (ms) |  p50 (us) |  p90 (us) |  p99 (us) |"
+            << "  max (us)"
             << std::endl;
 
-  for(const AgentWrapper& agent : wrappers) {
-    std::cout << std::right << std::setw(16) << agent.getName() << " | ";
-    std::cout << std::right << std::setw(10) << agent.totalPathCost << " | ";
-    std::cout << std::right << std::setw(10) << agent.totalMapLooks << " | ";
-    std::cout << std::right << std::setw(8) << agent.racesFinished;
+  for(const AgentWrapper* agent : rankings) {
+    std::cout << std::right << std::setw(16) << agent->getName() << " | ";
+    std::cout << std::right << std::setw(10) << agent->totalPathCost << " | ";
+    std::cout << std::right << std::setw(10) << agent->totalMapLooks << " | ";
+    if(allocStats) {
+      printAllocStats(agent->totalAllocations, agent->totalAllocatedBytes,
+                      agent->maxPeakHeapBytes);
+    }
+    std::cout << std::right << std::setw(8) << agent->racesFinished << " | ";
+    std::cout << std::right << std::setw(10)
+              << formatMillis(agent->totalCpuNanos);
+
+    for(const double fraction : {0.5, 0.9, 0.99}) {
+      std::cout << " | " << std::right << std::setw(9)
+                << formatMicros(agent->latency.percentile(fraction));
+    }
+
+    std::cout << " | " << std::right << std::setw(9)
+              << formatMicros(agent->latency.getMax());
     std::cout << std::endl;
   }
 
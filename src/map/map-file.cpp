@@ -0,0 +1,281 @@
+#include "map/map-file.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RALLY_HAVE_MMAP 1
+#endif
+
+namespace Rally {
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'A', 'L', 'L', 'Y', 'M', 'A', 'P'};
+
+void putLittle(unsigned char* out, uint64_t value, size_t bytes) {
+  for(size_t i = 0; i < bytes; ++i) {
+    out[i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+}
+
+uint64_t getLittle(const unsigned char* in, size_t bytes) {
+  uint64_t value = 0;
+  for(size_t i = 0; i < bytes; ++i) {
+    value |= static_cast<uint64_t>(in[i]) << (8 * i);
+  }
+  return value;
+}
+
+}  // namespace
+
+// A whole file, memory mapped where possible and read into memory otherwise.
+#ifdef RALLY_HAVE_MMAP
+class MappedFile {
+  void* base;
+  size_t length;
+
+ public:
+  explicit MappedFile(const std::string& path) : base(nullptr), length(0) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0) {
+      throw std::runtime_error("could not open map file " + path);
+    }
+
+    struct stat info;
+    if(::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw std::runtime_error("could not read map file " + path);
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    if(length > 0) {
+      base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+
+    if(base == MAP_FAILED) {
+      throw std::runtime_error("could not map map file " + path);
+    }
+  }
+
+  ~MappedFile() {
+    if(base != nullptr) {
+      ::munmap(base, length);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const unsigned char* data() const {
+    return static_cast<const unsigned char*>(base);
+  }
+  size_t size() const { return length; }
+};
+#else
+class MappedFile {
+  std::vector<unsigned char> bytes;
+
+ public:
+  explicit MappedFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+      throw std::runtime_error("could not open map file " + path);
+    }
+
+    bytes.assign(std::istreambuf_iterator<char>(in),
+                 std::istreambuf_iterator<char>());
+  }
+
+  const unsigned char* data() const { return bytes.data(); }
+  size_t size() const { return bytes.size(); }
+};
+#endif
+
+namespace {
+
+// The cells of one map inside a file. The file is kept open for as long as
+// any map reads from it.
+class FileCells : public CellStorage {
+  std::shared_ptr<const MappedFile> file;
+  size_t offset;
+  size_t length;
+
+ public:
+  FileCells(std::shared_ptr<const MappedFile> file,
+            size_t offset,
+            size_t length)
+      : file(std::move(file)), offset(offset), length(length) {}
+
+  const unsigned char* data() const { return file->data() + offset; }
+  size_t size() const { return length; }
+};
+
+}  // namespace
+
+// Appends a map file to the stream, which may already hold others.
+// Throws an exception if the stream can't be written to.
+void writeMapFile(std::ostream& out, const RallyMap& map) {
+  if(map.getEncoding() == Encoding::eWide) {
+    RallyMap narrow(map);
+    narrow.setEncoding(Encoding::eByte);
+    writeMapFile(out, narrow);
+    return;
+  }
+
+  const size_t cellBytes = RallyMap::memoryFootprint(
+      map.getEncoding(), map.getWidth(), map.getHeight(), map.getLayout());
+
+  unsigned char header[kMapFileHeaderSize] = {};
+  std::memcpy(header, kMagic, sizeof(kMagic));
+  putLittle(header + 8, kMapFileVersion, 4);
+  header[12] = static_cast<unsigned char>(map.getEncoding());
+  header[13] = static_cast<unsigned char>(map.getLayout());
+  putLittle(header + 16, map.getWidth(), 4);
+  putLittle(header + 20, map.getHeight(), 4);
+  putLittle(header + 24, static_cast<uint32_t>(map.getStart().x), 4);
+  putLittle(header + 28, static_cast<uint32_t>(map.getStart().y), 4);
+  putLittle(header + 32, static_cast<uint32_t>(map.getFinish().x), 4);
+  putLittle(header + 36, static_cast<uint32_t>(map.getFinish().y), 4);
+  putLittle(header + 40, cellBytes, 8);
+
+  out.write(reinterpret_cast<const char*>(header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(map.getCellData()), cellBytes);
+
+  if(!out) {
+    throw std::runtime_error("could not write map file");
+  }
+}
+
+void writeMapFile(const std::string& path, const RallyMap& map) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if(!out) {
+    throw std::runtime_error("could not create map file " + path);
+  }
+
+  writeMapFile(out, map);
+}
+
+// Opens the archive and finds where each map starts. The maps themselves
+// aren't checked until they're loaded.
+//
+// Throws an exception if the file can't be read, or isn't an archive.
+MapArchive::MapArchive(const std::string& path)
+    : path(path), file(new MappedFile(path)) {
+  const unsigned char* const data = file->data();
+  const size_t size = file->size();
+
+  if(size == 0) {
+    throw std::invalid_argument(path + " is empty");
+  }
+
+  for(size_t offset = 0; offset < size;) {
+    const unsigned char* const header = data + offset;
+
+    if(size - offset < kMapFileHeaderSize ||
+       std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+      throw std::invalid_argument(path + " is not a map file");
+    }
+
+    if(getLittle(header + 8, 4) != kMapFileVersion) {
+      throw std::invalid_argument(path + " has an unsupported version");
+    }
+
+    const uint64_t cellBytes = getLittle(header + 40, 8);
+    if(cellBytes > size - offset - kMapFileHeaderSize) {
+      throw std::invalid_argument(path + " is truncated");
+    }
+
+    offsets.push_back(offset);
+    offset += kMapFileHeaderSize + cellBytes;
+  }
+}
+
+// The number of maps in the archive.
+size_t MapArchive::size() const {
+  return offsets.size();
+}
+
+// Returns a map that reads its roughness straight from the archive. The
+// archive stays mapped until every map loaded from it is changed or
+// destroyed, even if the `MapArchive` itself is destroyed first.
+//
+// Throws an exception if the map isn't valid.
+RallyMap MapArchive::load(size_t i) const {
+  const size_t offset = offsets.at(i);
+  const unsigned char* const header = file->data() + offset;
+  const std::string name = path + " map " + std::to_string(i);
+
+  Encoding encoding;
+  switch(header[12]) {
+    case static_cast<unsigned char>(Encoding::eByte):
+      encoding = Encoding::eByte;
+      break;
+    case static_cast<unsigned char>(Encoding::eNibble):
+      encoding = Encoding::eNibble;
+      break;
+    default:
+      throw std::invalid_argument(name + " has an unknown encoding");
+  }
+
+  Layout layout;
+  switch(header[13]) {
+    case static_cast<unsigned char>(Layout::eDense):
+      layout = Layout::eDense;
+      break;
+    case static_cast<unsigned char>(Layout::ePadded):
+      layout = Layout::ePadded;
+      break;
+    default:
+      throw std::invalid_argument(name + " has an unknown layout");
+  }
+
+  // The map numbers its cells with a `uint`, padding included.
+  const uint64_t width = getLittle(header + 16, 4);
+  const uint64_t height = getLittle(header + 20, 4);
+  if((width + 2) * (height + 2) > UINT32_MAX) {
+    throw std::invalid_argument(name + " has invalid dimensions");
+  }
+
+  const auto coordinate = [&](size_t field) {
+    return static_cast<int32_t>(getLittle(header + field, 4));
+  };
+  const Point start = {coordinate(24), coordinate(28)};
+  const Point finish = {coordinate(32), coordinate(36)};
+
+  std::shared_ptr<const CellStorage> cells(
+      new FileCells(file, offset + kMapFileHeaderSize,
+                    getLittle(header + 40, 8)));
+
+  return RallyMap(width, height, start, finish, encoding, layout,
+                  std::move(cells));
+}
+
+// Memory maps the file and returns a map that reads its roughness straight
+// from it. The file stays mapped until the map, and every copy of it, is
+// changed or destroyed. Where memory mapping isn't available the cells are
+// read into memory instead.
+//
+// Throws an exception if the file can't be read, or isn't a valid map file
+// holding exactly one map.
+RallyMap loadMapFile(const std::string& path) {
+  const MapArchive archive(path);
+
+  if(archive.size() != 1) {
+    throw std::invalid_argument(path + " holds more than one map");
+  }
+
+  return archive.load(0);
+}
+
+}  // namespace Rally
@@ -1,4 +1,5 @@
 #include "rally-agent.h"
+#include "stats/clock.h"
 
 namespace Rally {
 
@@ -18,19 +19,99 @@ Point MapInterface::getFinish() const {
   return map.getFinish();
 }
 
+// Races with the same terrain id have the same roughness everywhere, other
+// than the start and finish. See `RallyMap::getTerrainId`.
+uint64_t MapInterface::getTerrainId() const {
+  return map.getTerrainId();
+}
+
+// Appends the hexes whose roughness was changed since the map had the given
+// terrain id, if the map still knows. This doesn't count as a map look, as it
+// doesn't say what the roughness is now. See `RallyMap::getEditsSince`.
+bool MapInterface::getEditsSince(uint64_t terrainId,
+                                 std::vector<Point>& edited) const {
+  return map.getEditsSince(terrainId, edited);
+}
+
 uint MapInterface::getMapLooks() const {
   return mapLooks;
 }
 
-MapInterface::MapInterface(const RallyMap& map) : map(map), mapLooks(0) {}
+uint MapInterface::getExpansions() const {
+  return expansions;
+}
+
+// Counts hexes or nodes the agent expanded in a graph of its own, rather than
+// by listing neighbors on the map.
+void MapInterface::addExpansions(uint count) {
+  expansions += count;
+}
+
+MapInterface::MapInterface(const RallyMap& map,
+                           Arena& arena,
+                           const SearchBudget& budget)
+    : map(map),
+      arena(arena),
+      mapLooks(0),
+      expansions(0),
+      budget(budget),
+      startNanos(budget.maxNanos > 0 ? wallNanos() : 0),
+      budgetChecks(0),
+      overBudget(false),
+      bound(0) {}
+
+const SearchBudget& MapInterface::getBudget() const {
+  return budget;
+}
+
+// Whether the agent has spent its budget, and should return the best path it
+// has found so far.
+bool MapInterface::isOverBudget() {
+  if(overBudget) {
+    return true;
+  }
+
+  if(budget.maxExpansions > 0 && expansions >= budget.maxExpansions) {
+    overBudget = true;
+  } else if(budget.maxNanos > 0 && ++budgetChecks % kClockInterval == 0) {
+    overBudget = wallNanos() - startNanos >= budget.maxNanos;
+  }
+
+  return overBudget;
+}
+
+// Lets an agent report that its path costs at most `nBound` times as much as
+// the cheapest path. Zero means nothing was reported.
+void MapInterface::reportBound(double nBound) {
+  bound = nBound;
+}
+
+double MapInterface::getBound() const {
+  return bound;
+}
+
+// Memory for the agent's containers that only lasts for this race. See
+// `ArenaVector` and the other containers in "search/arena.h".
+Arena& MapInterface::getArena() {
+  return arena;
+}
 
 // Creates a list of all the points surrounding the given one, and the
 // direction to that point.
-std::vector<std::pair<Point, Direction::T>> MapInterface::getNeighbors(
-    Point pos) const {
+NeighborList MapInterface::getNeighbors(Point pos) {
+  expansions += 1;
   return map.getNeighbors(pos);
 }
 
+// Creates a list of the points surrounding the given one that are worth
+// checking after arriving there by moving in `parentDir`. See
+// `Direction::kForwardDirections`.
+NeighborList MapInterface::getRelevantNeighbors(Point pos,
+                                                Direction::T parentDir) {
+  expansions += 1;
+  return map.getRelevantNeighbors(pos, parentDir);
+}
+
 // Determines the cost of moving in a given direction. If the move goes out
 // of bounds the agent returns to their starting position. This is not the
 // same as a no-op, and costs twice the roughness of the starting position.
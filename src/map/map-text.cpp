@@ -0,0 +1,192 @@
+#include "map/map-text.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace Rally {
+
+namespace {
+
+// Cells read from text, in the byte encoding and the dense layout. The map
+// shares them instead of copying them.
+class ParsedCells : public CellStorage {
+ public:
+  std::vector<unsigned char> cells;
+
+  const unsigned char* data() const { return cells.data(); }
+  size_t size() const { return cells.size(); }
+};
+
+std::invalid_argument parseError(size_t lineNumber, const std::string& reason) {
+  return std::invalid_argument("map text line " + std::to_string(lineNumber) +
+                               ": " + reason);
+}
+
+// The column of the '|' if the line is a start or finish marker.
+size_t markerColumn(const std::string& line) {
+  const size_t column = line.find_first_not_of(' ');
+
+  if(column == std::string::npos || line[column] != '|' ||
+     column + 1 != line.size()) {
+    return std::string::npos;
+  }
+
+  return column;
+}
+
+}  // namespace
+
+// Reads a map written as text, in either the rhombus or the compact format.
+// Throws an exception naming the line at fault if the text isn't a valid
+// map.
+RallyMap parseMapText(std::istream& in, Encoding encoding, Layout layout) {
+  std::shared_ptr<ParsedCells> storage(new ParsedCells);
+  std::vector<unsigned char>& cells = storage->cells;
+
+  uint width = 0;
+  uint height = 0;
+  Point start = {-1, -1};
+  Point finish = {-1, -1};
+  size_t startMarker = std::string::npos;
+  size_t finishMarker = std::string::npos;
+
+  // The format is decided by the first row. Rhombus rows have spaces between
+  // the hexes, and compact rows don't.
+  bool rhombus = false;
+  // Set once the map is over, after which only blank lines may follow.
+  bool ended = false;
+
+  std::string line;
+  size_t lineNumber = 0;
+
+  while(std::getline(in, line)) {
+    ++lineNumber;
+
+    while(!line.empty() && (line.back() == '\r' || line.back() == ' ')) {
+      line.pop_back();
+    }
+
+    if(line.empty()) {
+      ended = ended || height > 0;
+      continue;
+    } else if(ended) {
+      throw parseError(lineNumber, "text after the end of the map");
+    }
+
+    const size_t marker = markerColumn(line);
+    if(marker != std::string::npos) {
+      if(height > 0) {
+        finishMarker = marker;
+        ended = true;
+      } else if(startMarker == std::string::npos) {
+        startMarker = marker;
+        rhombus = true;
+      } else {
+        throw parseError(lineNumber, "expected a row of hexes");
+      }
+      continue;
+    }
+
+    if(height == 0 && startMarker == std::string::npos) {
+      rhombus = line.find(' ') != std::string::npos;
+    }
+
+    size_t pos = 0;
+    if(rhombus) {
+      pos = line.find_first_not_of(' ');
+      if(pos != height) {
+        throw parseError(lineNumber, "row " + std::to_string(height) +
+                                         " should start with " +
+                                         std::to_string(height) + " spaces");
+      }
+    }
+
+    uint x = 0;
+    while(pos < line.size()) {
+      const char c = line[pos];
+      const Point here = {static_cast<int>(x), static_cast<int>(height)};
+
+      if(c >= '1' && c <= '0' + static_cast<int>(kMaxRoughness)) {
+        cells.push_back(static_cast<unsigned char>(c - '0'));
+      } else if(c == '*' && start.x < 0) {
+        start = here;
+        cells.push_back(1);
+      } else if(c == '&' && finish.x < 0) {
+        finish = here;
+        cells.push_back(1);
+      } else if(c == '*' || c == '&') {
+        throw parseError(lineNumber, std::string("more than one '") + c + "'");
+      } else {
+        throw parseError(lineNumber, std::string("unexpected '") + c + "'");
+      }
+
+      ++x;
+      ++pos;
+
+      if(rhombus && pos < line.size()) {
+        if(line[pos] != ' ' || line[pos + 1] == ' ') {
+          throw parseError(lineNumber,
+                           "hexes should be separated by single spaces");
+        }
+        ++pos;
+      }
+    }
+
+    if(height == 0) {
+      width = x;
+    } else if(x != width) {
+      throw parseError(lineNumber, "row has " + std::to_string(x) +
+                                       " hexes instead of " +
+                                       std::to_string(width));
+    }
+
+    // The map numbers its cells with a `uint`, padding included.
+    if(static_cast<uint64_t>(width + 2) * (height + 3) > UINT32_MAX) {
+      throw parseError(lineNumber, "the map is too large");
+    }
+
+    ++height;
+  }
+
+  if(in.bad()) {
+    throw std::runtime_error("could not read map text");
+  } else if(height < 2 || width < 2) {
+    throw std::invalid_argument("map text is smaller than 2x2");
+  } else if(start.x < 0 || finish.x < 0) {
+    throw std::invalid_argument("map text needs both a '*' and a '&'");
+  }
+
+  if(startMarker != std::string::npos &&
+     startMarker != static_cast<size_t>(start.x * 2 + start.y)) {
+    throw std::invalid_argument("the start marker isn't above the start");
+  }
+
+  if(finishMarker != std::string::npos &&
+     finishMarker != static_cast<size_t>(finish.x * 2 + finish.y)) {
+    throw std::invalid_argument("the finish marker isn't below the finish");
+  }
+
+  RallyMap map(width, height, start, finish, Encoding::eByte, Layout::eDense,
+               std::move(storage));
+  map.setEncoding(encoding);
+  map.setLayout(layout);
+
+  return map;
+}
+
+// Throws an exception if the file can't be read, or isn't a valid map.
+RallyMap loadMapText(const std::string& path,
+                     Encoding encoding,
+                     Layout layout) {
+  std::ifstream in(path);
+  if(!in) {
+    throw std::runtime_error("could not open map text " + path);
+  }
+
+  return parseMapText(in, encoding, layout);
+}
+
+}  // namespace Rally
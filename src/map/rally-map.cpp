@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <stdexcept>
@@ -6,6 +7,114 @@
 
 namespace Rally {
 
+namespace {
+
+// Terrain ids are unique across every map in the process.
+uint64_t newTerrainId() {
+  static std::atomic<uint64_t> nextTerrainId(1);
+  return nextTerrainId++;
+}
+
+}  // namespace
+
+// Returns a human readable name for the given `Encoding`.
+const char* encodingName(Encoding encoding) {
+  switch(encoding) {
+    case Encoding::eWide:
+      return "wide";
+    case Encoding::eByte:
+      return "byte";
+    case Encoding::eNibble:
+      return "nibble";
+    // Just in case.
+    default:
+      return "unknown";
+  }
+}
+
+// Sets `stride`, `origin`, and `cellOffsets` for the current dimensions and
+// layout.
+void RallyMap::computeStrides() {
+  if(layout == Layout::ePadded) {
+    stride = width + 2;
+    origin = stride + 1;
+  } else {
+    stride = width;
+    origin = 0;
+  }
+
+  for(const auto& dir : Direction::kAllMoveDirections) {
+    const Point offset = kMoveOffsets[static_cast<size_t>(dir)];
+    cellOffsets[static_cast<size_t>(dir)] =
+        offset.y * static_cast<int>(stride) + offset.x;
+  }
+  cellOffsets[static_cast<size_t>(Direction::T::eNone)] = 0;
+}
+
+// Resizes `cells` to fit the current dimensions, encoding, and layout. The
+// roughness of every hex, and every sentinel, is left at zero.
+void RallyMap::allocateCells() {
+  computeStrides();
+  cells.assign(memoryFootprint(encoding, width, height, layout));
+}
+
+// Converts the map to the given encoding and layout.
+void RallyMap::repack(Encoding nEncoding, Layout nLayout) {
+  if(nEncoding == encoding && nLayout == layout) {
+    return;
+  }
+
+  const RallyMap original(*this);
+  encoding = nEncoding;
+  layout = nLayout;
+  cells.release();
+  allocateCells();
+
+  for(int y = 0; y < static_cast<int>(height); ++y) {
+    for(int x = 0; x < static_cast<int>(width); ++x) {
+      setCellRoughness(index({x, y}),
+                       original.cellRoughness(original.index({x, y})));
+    }
+  }
+}
+
+// Repacks the roughness of every hex with the given encoding.
+void RallyMap::setEncoding(Encoding nEncoding) {
+  repack(nEncoding, layout);
+}
+
+// Rearranges the roughness of every hex with the given layout.
+void RallyMap::setLayout(Layout nLayout) {
+  repack(encoding, nLayout);
+}
+
+// The number of bytes used to store the roughness of the map.
+size_t RallyMap::getMemoryFootprint() const {
+  return cells.capacity();
+}
+
+// The number of bytes needed to store the roughness of a map with the given
+// encoding, dimensions, and layout.
+size_t RallyMap::memoryFootprint(Encoding encoding,
+                                 uint width,
+                                 uint height,
+                                 Layout layout) {
+  size_t hexes = static_cast<size_t>(width) * height;
+
+  if(layout == Layout::ePadded) {
+    hexes = static_cast<size_t>(width + 2) * (height + 2);
+  }
+
+  switch(encoding) {
+    case Encoding::eByte:
+      return hexes;
+    case Encoding::eNibble:
+      return (hexes + 1) / 2;
+    default:
+      return hexes * sizeof(uint);
+  }
+}
+
 // This throws an exception if the start and finish are the same or if
 // either point is outside of the map.
 void RallyMap::setEndPoints(Point nStart, Point nFinish) {
@@ -27,15 +136,20 @@ void RallyMap::setEndPoints(Point nStart, Point nFinish) {
 
 // Sets the start and finish to random Points.
 void RallyMap::randomizeEndPoints() {
-  start = {static_cast<int>(rand() % width), static_cast<int>(rand() % height)};
+  randomizeEndPoints(Random::local());
+}
+
+void RallyMap::randomizeEndPoints(Random& random) {
+  start = {static_cast<int>(random.below(width)),
+           static_cast<int>(random.below(height))};
 
   finish = start;
 
   // This is theoretically an infinite loop. With the 2x2 minimum map size
   // this should never be a problem.
   while(finish.x == start.x && finish.y == start.y) {
-    finish = {static_cast<int>(rand() % width),
-              static_cast<int>(rand() % height)};
+    finish = {static_cast<int>(random.below(width)),
+              static_cast<int>(random.below(height))};
   }
 }
 
@@ -45,37 +159,97 @@ uint RallyMap::getRoughness(Point pos) const {
     throw std::range_error("invalid position");
   }
 
-  return roughness[pos.y][pos.x];
+  return cellRoughness(index(pos));
 }
 
 // If the value given is 0, then the roughness is set to a random value.
 // Values above the max roughness are set to the max.
 // Throws an exception if the position is out of bounds.
 void RallyMap::setRoughness(Point pos, uint newRoughness) {
+  setRoughness(pos, newRoughness, Random::local());
+}
+
+void RallyMap::setRoughness(Point pos, uint newRoughness, Random& random) {
   if(!pos.inBounds(0, 0, width, height)) {
     throw std::range_error("invalid position");
   }
 
+  const uint cell = index(pos);
+  cells.own();
+
+  if(edits.size() == kMaxEdits) {
+    edits.erase(edits.begin(), edits.begin() + kMaxEdits / 2);
+  }
+  edits.push_back({terrainId, pos});
+  terrainId = newTerrainId();
+
   if(newRoughness > kMaxRoughness) {
-    roughness[pos.y][pos.x] = kMaxRoughness;
+    setCellRoughness(cell, kMaxRoughness);
   } else if(newRoughness == 0) {
-    roughness[pos.y][pos.x] = rand() % kMaxRoughness + 1;
+    setCellRoughness(cell, random.below(kMaxRoughness) + 1);
   } else {
-    roughness[pos.y][pos.x] = newRoughness;
+    setCellRoughness(cell, newRoughness);
   }
 }
 
+// Appends the hexes `setRoughness` changed since the map had the given
+// terrain id to `edited`. Returns false if the map's roughness has been set
+// as a whole since then, or if too many hexes were changed, in which case
+// nothing is appended.
+bool RallyMap::getEditsSince(uint64_t oldTerrainId,
+                             std::vector<Point>& edited) const {
+  if(oldTerrainId == terrainId) {
+    return true;
+  }
+
+  for(size_t i = edits.size(); i-- > 0;) {
+    if(edits[i].first == oldTerrainId) {
+      for(; i < edits.size(); ++i) {
+        edited.push_back(edits[i].second);
+      }
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
 // Randomizes the roughness of the entire map.
 void RallyMap::randomizeRoughness() {
+  randomizeRoughness(Random::local());
+}
+
+void RallyMap::randomizeRoughness(Random& random) {
+  cells.own();
+  terrainId = newTerrainId();
+  edits.clear();
+
   for(uint y = 0; y < height; ++y) {
-    for(uint x = 0; x < width; ++x) {
-      roughness[y][x] = rand() % kMaxRoughness + 1;
-    }
+    const uint rowStart = origin + y * stride;
+
+    random.fillRange(width, kMaxRoughness, [&](uint64_t x, uint value) {
+      setCellRoughness(rowStart + x, value);
+    });
   }
 }
 
 std::vector<std::vector<uint>> RallyMap::getAllRoughness() const {
-  return roughness;
+  std::vector<std::vector<uint>> rows;
+  rows.reserve(height);
+
+  for(uint y = 0; y < height; ++y) {
+    std::vector<uint> row(width);
+    const uint rowStart = origin + y * stride;
+
+    for(uint x = 0; x < width; ++x) {
+      row[x] = cellRoughness(rowStart + x);
+    }
+
+    rows.push_back(std::move(row));
+  }
+
+  return rows;
 }
 
 // The map is resized and the roughness is set based on the given template.
@@ -87,6 +261,13 @@ std::vector<std::vector<uint>> RallyMap::getAllRoughness() const {
 void RallyMap::setMap(Point start,
                       Point finish,
                       const std::vector<std::vector<uint>>& mapTemplate) {
+  setMap(start, finish, mapTemplate, Random::local());
+}
+
+void RallyMap::setMap(Point start,
+                      Point finish,
+                      const std::vector<std::vector<uint>>& mapTemplate,
+                      Random& random) {
   height = mapTemplate.size();
   width = mapTemplate[0].size();
 
@@ -102,25 +283,40 @@ void RallyMap::setMap(Point start,
 
   setEndPoints(start, finish);
 
-  roughness = mapTemplate;
+  allocateCells();
+  terrainId = newTerrainId();
+  edits.clear();
 
   // Set random values and clamp top of range
   for(uint y = 0; y < height; ++y) {
     for(uint x = 0; x < width; ++x) {
-      if(roughness[y][x] == 0) {
-        roughness[y][x] = rand() % kMaxRoughness + 1;
-      } else if(roughness[y][x] > kMaxRoughness) {
-        roughness[y][x] = kMaxRoughness;
+      uint value = mapTemplate[y][x];
+
+      if(value == 0) {
+        value = random.below(kMaxRoughness) + 1;
+      } else if(value > kMaxRoughness) {
+        value = kMaxRoughness;
       }
+
+      setCellRoughness(origin + y * stride + x, value);
     }
   }
 }
 
-// Creates a random map with the given dimensions.
+// Creates a random map with the given dimensions. Without a `Random` the
+// map is different every run.
 //
 // Throws an exception if either of the template's dimensions are smaller
 // than two.
-RallyMap::RallyMap(uint width, uint height) {
+RallyMap::RallyMap(uint width, uint height, Encoding encoding, Layout layout)
+    : RallyMap(width, height, Random::local(), encoding, layout) {}
+
+RallyMap::RallyMap(uint width,
+                   uint height,
+                   Random& random,
+                   Encoding encoding,
+                   Layout layout)
+    : encoding(encoding), layout(layout) {
   if(width < 2 || height < 2) {
     throw std::invalid_argument("map dimensions too small");
   }
@@ -128,12 +324,10 @@ RallyMap::RallyMap(uint width, uint height) {
   this->height = height;
   this->width = width;
 
-  for(uint y = 0; y < height; ++y) {
-    roughness.push_back(std::vector<uint>(width, 1));
-  }
+  allocateCells();
 
-  randomizeRoughness();
-  randomizeEndPoints();
+  randomizeRoughness(random);
+  randomizeEndPoints(random);
 }
 
 // Creates a map from the given template. This works the same way as calling
@@ -143,11 +337,80 @@ RallyMap::RallyMap(uint width, uint height) {
 // than two or if the template is jagged.
 RallyMap::RallyMap(Point startPos,
                    Point finishPos,
-                   const std::vector<std::vector<uint>>& mapTemplate)
-    : start({-1, -1}), finish({-1, -1}) {
+                   const std::vector<std::vector<uint>>& mapTemplate,
+                   Encoding encoding,
+                   Layout layout)
+    : start({-1, -1}),
+      finish({-1, -1}),
+      encoding(encoding),
+      layout(layout) {
   setMap(startPos, finishPos, mapTemplate);
 }
 
+// Creates a map that reads its roughness straight from `storage`, without
+// copying it. The map stays read-only until it's changed, at which point it
+// copies the cells and lets go of the storage.
+//
+// Throws an exception if either dimension is smaller than two, the end
+// points aren't valid, the storage is the wrong size, or any cell holds a
+// roughness the map couldn't have made itself.
+RallyMap::RallyMap(uint width,
+                   uint height,
+                   Point startPos,
+                   Point finishPos,
+                   Encoding encoding,
+                   Layout layout,
+                   std::shared_ptr<const CellStorage> storage)
+    : width(width), height(height), encoding(encoding), layout(layout) {
+  if(width < 2 || height < 2) {
+    throw std::invalid_argument("map dimensions too small");
+  }
+
+  setEndPoints(startPos, finishPos);
+
+  if(!storage ||
+     storage->size() != memoryFootprint(encoding, width, height, layout)) {
+    throw std::invalid_argument("cell storage is the wrong size");
+  }
+
+  computeStrides();
+  cells.share(std::move(storage));
+  terrainId = newTerrainId();
+  edits.clear();
+
+  // The agents and the padded layout both rely on the roughness being in
+  // range, so a bad cell could otherwise send a search off the map.
+  for(uint y = 0; y < height; ++y) {
+    const uint rowStart = origin + y * stride;
+
+    for(uint x = 0; x < width; ++x) {
+      const uint value = cellRoughness(rowStart + x);
+
+      if(value == 0 || value > kMaxRoughness) {
+        throw std::invalid_argument("cell roughness out of range");
+      }
+    }
+  }
+
+  if(layout == Layout::ePadded) {
+    bool sentinelsZero = true;
+
+    for(uint x = 0; x < stride; ++x) {
+      sentinelsZero &= cellRoughness(x) == 0 &&
+                       cellRoughness((height + 1) * stride + x) == 0;
+    }
+
+    for(uint y = 1; y <= height; ++y) {
+      sentinelsZero &= cellRoughness(y * stride) == 0 &&
+                       cellRoughness(y * stride + width + 1) == 0;
+    }
+
+    if(!sentinelsZero) {
+      throw std::invalid_argument("sentinel roughness is not zero");
+    }
+  }
+}
+
 // Calculates the cost of the path, and if it ends on the finish.
 std::pair<uint, bool> RallyMap::analyzePath(
     const std::vector<Direction::T>& path) const {
@@ -188,16 +451,25 @@ uint RallyMap::calculatePathCost(const std::vector<Direction::T>& path) const {
 
 // Creates a list of all the points surrounding the given one, and the
 // direction to that point.
-std::vector<std::pair<Point, Direction::T>> RallyMap::getNeighbors(
-    Point pos) const {
-  std::vector<std::pair<Point, Direction::T>> neighborList;
-  neighborList.reserve(6);
+NeighborList RallyMap::getNeighbors(Point pos) const {
+  return getRelevantNeighbors(pos, Direction::T::eNone);
+}
 
-  for(const auto& dir : Direction::kAllMoveDirections) {
-    auto neighbor = getDestination(pos, dir);
+// Creates a list of the points surrounding the given one that are worth
+// checking after arriving there by moving in `parentDir`. See
+// `Direction::kForwardDirections`.
+NeighborList RallyMap::getRelevantNeighbors(Point pos,
+                                            Direction::T parentDir) const {
+  const Direction::DirectionList& forward =
+      Direction::kForwardDirections[static_cast<size_t>(parentDir)];
+  NeighborList neighborList;
+
+  for(uint i = 0; i < forward.size; ++i) {
+    const Direction::T dir = forward.dirs[i];
+    const Point neighbor = getDestination(pos, dir);
 
     if(neighbor != pos) {
-      neighborList.push_back(std::pair<Point, Direction::T>(neighbor, dir));
+      neighborList.push_back({neighbor, dir});
     }
   }
 
@@ -210,8 +482,8 @@ std::vector<std::pair<Point, Direction::T>> RallyMap::getNeighbors(
 uint RallyMap::getMoveCost(Point pos, Direction::T dir) const {
   auto there = getDestination(pos, dir);
 
-  uint roughHere = roughness[pos.y][pos.x];
-  uint roughThere = roughness[there.y][there.x];
+  uint roughHere = cellRoughness(index(pos));
+  uint roughThere = cellRoughness(index(there));
 
   if(pos == start || pos == finish) {
     roughHere = 1;
@@ -228,6 +500,19 @@ uint RallyMap::getMoveCost(Point pos, Direction::T dir) const {
 // direction. In the case of moving out of bounds, the original Point
 // is returned.
 Point RallyMap::getDestination(Point pos, Direction::T dir) const {
+  // The sentinels surrounding a padded map have a roughness of zero, so the
+  // move only happens if the destination isn't a sentinel.
+  if(layout == Layout::ePadded) {
+    const size_t dirIndex = static_cast<size_t>(dir);
+    const int inside =
+        cellRoughness(index(pos) + cellOffsets[dirIndex]) != 0 ? 1 : 0;
+
+    pos.x += kMoveOffsets[dirIndex].x * inside;
+    pos.y += kMoveOffsets[dirIndex].y * inside;
+
+    return pos;
+  }
+
   switch(dir) {
     // North       x+1, y-1
     case Direction::T::eNorth:
@@ -277,6 +562,10 @@ Point RallyMap::getDestination(Point pos, Direction::T dir) const {
 std::string RallyMap::toString() const {
   std::string out = "";
 
+  // Each row is the front spacing followed by every value and its separator.
+  out.reserve((start.x * 2 + start.y + 2) + (finish.x * 2 + finish.y + 2) +
+              height * (height + width * 2));
+
   // Add top indicator for the start.
   for(int x = 0; x < start.x * 2 + start.y; ++x) {
     out += " ";
@@ -284,6 +573,8 @@ std::string RallyMap::toString() const {
   out += "|\n";
 
   for(uint y = 0; y < height; ++y) {
+    const uint rowStart = origin + y * stride;
+
     // Add front spacing
     for(uint space = 0; space < y; ++space) {
       out += " ";
@@ -297,7 +588,8 @@ std::string RallyMap::toString() const {
                 static_cast<uint>(finish.y) == y) {
         out += "&";
       } else {
-        out += std::to_string(roughness[y][x]);
+        // Only single digit roughness values are supported.
+        out += static_cast<char>('0' + cellRoughness(rowStart + x));
       }
 
       if(x + 1 != width) {
@@ -0,0 +1,55 @@
+#include "map/random.h"
+
+#include <chrono>
+#include <random>
+
+namespace Rally {
+
+namespace {
+
+inline uint64_t splitMix(uint64_t& x) {
+  uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+}  // namespace
+
+// The seed is spread over the whole state with splitmix64, so similar seeds
+// still give unrelated sequences.
+Random::Random(uint64_t seed) {
+  for(auto& word : state) {
+    word = splitMix(seed);
+  }
+}
+
+// Mixes a seed and a stream number into a new seed. This is used to give
+// each race its own generator, so a race is the same no matter what order
+// or what thread it's run on.
+uint64_t Random::deriveSeed(uint64_t seed, uint64_t stream) {
+  uint64_t mixed = seed;
+  splitMix(mixed);
+  mixed ^= stream;
+  return splitMix(mixed);
+}
+
+// A seed that is different every run.
+uint64_t Random::randomSeed() {
+  std::random_device device;
+  const uint64_t entropy =
+      (static_cast<uint64_t>(device()) << 32) | static_cast<uint64_t>(device());
+  const uint64_t time =
+      std::chrono::high_resolution_clock::now().time_since_epoch().count();
+
+  return deriveSeed(entropy, time);
+}
+
+// A generator for the current thread with a seed that is different every
+// run. Used when a generator isn't given explicitly.
+Random& Random::local() {
+  static thread_local Random random(randomSeed());
+  return random;
+}
+
+}  // namespace Rally
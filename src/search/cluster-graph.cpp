@@ -0,0 +1,401 @@
+#include "search/cluster-graph.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+
+namespace Rally {
+
+namespace {
+
+// The direction of the move between two neighboring hexes.
+Direction::T directionBetween(const Point& from, const Point& to) {
+  for(const auto dir : Direction::kAllMoveDirections) {
+    if(from + kMoveOffsets[static_cast<size_t>(dir)] == to) {
+      return dir;
+    }
+  }
+
+  return Direction::T::eNone;
+}
+
+// Every move costs at least two, so this never overestimates.
+inline uint hueristic(const Point& a, const Point& b) {
+  return a.distanceTo(b) * 2;
+}
+
+}  // namespace
+
+// Finds the cheapest path from `source` to every hex from `bottomLeft` up to
+// but not including `topRight`, without leaving the rectangle. The search
+// stops early once `target` is reached, if it's given.
+void LocalSearch::run(const TerrainCache& terrain,
+                      Point source,
+                      Point nBottomLeft,
+                      Point nTopRight,
+                      Point target) {
+  bottomLeft = nBottomLeft;
+  topRight = nTopRight;
+
+  const size_t width = topRight.x - bottomLeft.x;
+  const size_t size = width * (topRight.y - bottomLeft.y);
+  if(size > costs.size()) {
+    costs.resize(size);
+    parentDirs.resize(size);
+  }
+  stamps.reset(size);
+
+  expansions = 0;
+  const size_t sourceIndex = index(source);
+  stamps.mark(sourceIndex);
+  costs[sourceIndex] = 0;
+  parentDirs[sourceIndex] = Direction::T::eNone;
+
+  frontier.clear();
+  frontier.push(0, static_cast<uint>(sourceIndex));
+
+  while(!frontier.empty()) {
+    const uint frontCost = frontier.topKey();
+    const uint front = frontier.top();
+    frontier.pop();
+
+    if(frontCost != costs[front]) {
+      continue;
+    }
+
+    ++expansions;
+
+    const Point frontPoint = {bottomLeft.x + static_cast<int>(front % width),
+                              bottomLeft.y + static_cast<int>(front / width)};
+    if(frontPoint == target) {
+      break;
+    }
+
+    for(const auto dir : Direction::kAllMoveDirections) {
+      const Point nearPoint =
+          frontPoint + kMoveOffsets[static_cast<size_t>(dir)];
+      if(!nearPoint.inBounds(bottomLeft, topRight)) {
+        continue;
+      }
+
+      const size_t near = index(nearPoint);
+      const uint cost = frontCost + terrain.getMoveCost(frontPoint, nearPoint);
+
+      if(!stamps.isMarked(near) || cost < costs[near]) {
+        stamps.mark(near);
+        costs[near] = cost;
+        parentDirs[near] = dir;
+        frontier.push(cost, static_cast<uint>(near));
+      }
+    }
+  }
+}
+
+// Appends the moves from the source to a reached hex.
+void LocalSearch::appendPathTo(Point pos,
+                               std::vector<Direction::T>& path) const {
+  const size_t first = path.size();
+
+  for(Direction::T dir = parentDirs[index(pos)]; dir != Direction::T::eNone;
+      dir = parentDirs[index(pos)]) {
+    path.push_back(dir);
+    pos = pos - kMoveOffsets[static_cast<size_t>(dir)];
+  }
+
+  std::reverse(path.begin() + first, path.end());
+}
+
+// Appends the moves from a reached hex back to the source.
+void LocalSearch::appendPathFrom(Point pos,
+                                 std::vector<Direction::T>& path) const {
+  for(Direction::T dir = parentDirs[index(pos)]; dir != Direction::T::eNone;
+      dir = parentDirs[index(pos)]) {
+    path.push_back(Direction::reverse(dir));
+    pos = pos - kMoveOffsets[static_cast<size_t>(dir)];
+  }
+}
+
+ClusterGraph::ClusterGraph(uint clusterSize)
+    : clusterSize(clusterSize),
+      width(0),
+      height(0),
+      clustersX(0),
+      clustersY(0),
+      expansions(0) {}
+
+Point ClusterGraph::clusterBottomLeft(uint cluster) const {
+  return {static_cast<int>(cluster % clustersX * clusterSize),
+          static_cast<int>(cluster / clustersX * clusterSize)};
+}
+
+Point ClusterGraph::clusterTopRight(uint cluster) const {
+  const Point bottomLeft = clusterBottomLeft(cluster);
+  return {std::min(bottomLeft.x + static_cast<int>(clusterSize),
+                   static_cast<int>(width)),
+          std::min(bottomLeft.y + static_cast<int>(clusterSize),
+                   static_cast<int>(height))};
+}
+
+// Recomputes the edges between the nodes of a cluster.
+void ClusterGraph::buildCluster(const TerrainCache& terrain, uint cluster) {
+  const Point bottomLeft = clusterBottomLeft(cluster);
+  const Point topRight = clusterTopRight(cluster);
+
+  for(const uint from : clusterNodes[cluster]) {
+    refineSearch.run(terrain, nodes[from].pos, bottomLeft, topRight);
+    intraEdges[from].clear();
+
+    for(const uint to : clusterNodes[cluster]) {
+      if(to != from) {
+        intraEdges[from].push_back(
+            Edge{to, refineSearch.getCost(nodes[to].pos)});
+      }
+    }
+  }
+}
+
+// Builds the graph for every hex in the cache.
+void ClusterGraph::build(const TerrainCache& terrain) {
+  width = terrain.getWidth();
+  height = terrain.getHeight();
+  clustersX = (width + clusterSize - 1) / clusterSize;
+  clustersY = (height + clusterSize - 1) / clusterSize;
+
+  const uint numClusters = clustersX * clustersY;
+  nodes.clear();
+  intraEdges.clear();
+  interEdges.clear();
+  clusterNodes.assign(numClusters, std::vector<uint>());
+
+  // Each side of a cluster is split into two stretches, and the cheapest
+  // crossing in each stretch becomes an entrance.
+  const uint stretch = std::max(clusterSize / 2, 1u);
+
+  struct Crossing {
+    Point from;
+    Point to;
+    uint cost;
+  };
+
+  // Ordered so the nodes are numbered the same way every time.
+  std::map<uint64_t, Crossing> crossings;
+
+  for(int y = 0; y < static_cast<int>(height); ++y) {
+    const uint localY = y % clusterSize;
+
+    for(int x = 0; x < static_cast<int>(width); ++x) {
+      const uint localX = x % clusterSize;
+
+      // Only hexes on the edge of a cluster can cross into another.
+      if(localX != 0 && localX != clusterSize - 1 && localY != 0 &&
+         localY != clusterSize - 1) {
+        continue;
+      }
+
+      const Point from = {x, y};
+      const uint fromCluster = clusterOf(from);
+
+      for(const auto dir : Direction::kAllMoveDirections) {
+        const Point to = from + kMoveOffsets[static_cast<size_t>(dir)];
+
+        // Each pair of clusters is only looked at from the lower numbered one.
+        if(!terrain.inBounds(to) || clusterOf(to) <= fromCluster) {
+          continue;
+        }
+
+        uint along = 0;
+        if(to.y / clusterSize == from.y / clusterSize) {
+          along = localY / stretch;
+        } else if(to.x / clusterSize == from.x / clusterSize) {
+          along = localX / stretch;
+        }
+
+        const uint64_t key =
+            (static_cast<uint64_t>(fromCluster) * numClusters + clusterOf(to)) *
+                clusterSize +
+            along;
+        const uint cost = terrain.getMoveCost(from, to);
+
+        auto found = crossings.find(key);
+        if(found == crossings.end()) {
+          crossings.emplace(key, Crossing{from, to, cost});
+        } else if(cost < found->second.cost) {
+          found->second = Crossing{from, to, cost};
+        }
+      }
+    }
+  }
+
+  std::unordered_map<size_t, uint> hexNodes;
+  auto nodeAt = [&](const Point& pos) {
+    auto found = hexNodes.find(terrain.index(pos));
+    if(found != hexNodes.end()) {
+      return found->second;
+    }
+
+    const uint node = static_cast<uint>(nodes.size());
+    nodes.push_back(Node{pos, clusterOf(pos)});
+    intraEdges.emplace_back();
+    interEdges.emplace_back();
+    clusterNodes[nodes.back().cluster].push_back(node);
+    hexNodes.emplace(terrain.index(pos), node);
+
+    return node;
+  };
+
+  for(const auto& entry : crossings) {
+    const uint from = nodeAt(entry.second.from);
+    const uint to = nodeAt(entry.second.to);
+
+    if(std::find(interEdges[from].begin(), interEdges[from].end(), to) ==
+       interEdges[from].end()) {
+      interEdges[from].push_back(to);
+      interEdges[to].push_back(from);
+    }
+  }
+
+  for(uint cluster = 0; cluster < numClusters; ++cluster) {
+    buildCluster(terrain, cluster);
+  }
+}
+
+// Updates the graph after the roughness of the given hexes changed.
+void ClusterGraph::repair(const TerrainCache& terrain,
+                          const std::vector<Point>& changed) {
+  std::vector<uint> clusters;
+  for(const Point& pos : changed) {
+    clusters.push_back(clusterOf(pos));
+  }
+
+  std::sort(clusters.begin(), clusters.end());
+  clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+
+  // The entrances stay where they are, which is only a question of how good
+  // the paths are. The costs across entrances are never stored.
+  for(const uint cluster : clusters) {
+    buildCluster(terrain, cluster);
+  }
+}
+
+// Finds a path from `start` to `finish` on the terrain the graph was built
+// for.
+std::vector<Direction::T> ClusterGraph::findPath(const TerrainCache& terrain,
+                                                 Point start,
+                                                 Point finish) {
+  // The start and finish are added to the graph for this query only.
+  const uint startNode = static_cast<uint>(nodes.size());
+  const uint finishNode = startNode + 1;
+
+  if(finishNode + 1 > costs.size()) {
+    costs.resize(finishNode + 1);
+    parents.resize(finishNode + 1);
+  }
+  stamps.reset(finishNode + 1);
+
+  const uint startCluster = clusterOf(start);
+  const uint finishCluster = clusterOf(finish);
+  startSearch.run(terrain, start, clusterBottomLeft(startCluster),
+                  clusterTopRight(startCluster));
+  finishSearch.run(terrain, finish, clusterBottomLeft(finishCluster),
+                   clusterTopRight(finishCluster));
+  expansions = startSearch.getExpansions() + finishSearch.getExpansions();
+
+  auto posOf = [&](uint node) {
+    return node == startNode ? start : node == finishNode ? finish
+                                                          : nodes[node].pos;
+  };
+
+  auto estimate = [&](uint node) {
+    return node == finishNode ? 0 : hueristic(posOf(node), finish);
+  };
+
+  auto relax = [&](uint node, uint cost, uint parent) {
+    if(!stamps.isMarked(node) || cost < costs[node]) {
+      stamps.mark(node);
+      costs[node] = cost;
+      parents[node] = parent;
+      frontier.push({cost + estimate(node), node});
+    }
+  };
+
+  frontier.clear();
+  relax(startNode, 0, startNode);
+
+  // A* on the abstract graph.
+  while(!frontier.empty()) {
+    const uint front = frontier.top().second;
+    const uint frontEstimate = frontier.top().first;
+    frontier.pop();
+
+    const uint frontCost = costs[front];
+    if(frontEstimate != frontCost + estimate(front)) {
+      continue;
+    }
+
+    ++expansions;
+
+    if(front == finishNode) {
+      break;
+    }
+
+    if(front == startNode) {
+      for(const uint node : clusterNodes[startCluster]) {
+        relax(node, startSearch.getCost(nodes[node].pos), startNode);
+      }
+
+      if(startCluster == finishCluster) {
+        relax(finishNode, startSearch.getCost(finish), startNode);
+      }
+
+      continue;
+    }
+
+    const Point frontPoint = nodes[front].pos;
+
+    for(const Edge& edge : intraEdges[front]) {
+      relax(edge.to, frontCost + edge.cost, front);
+    }
+
+    for(const uint near : interEdges[front]) {
+      relax(near, frontCost + terrain.getMoveCost(frontPoint, nodes[near].pos),
+            front);
+    }
+
+    if(nodes[front].cluster == finishCluster) {
+      relax(finishNode, frontCost + finishSearch.getCost(frontPoint), front);
+    }
+  }
+
+  // Every cluster touches its neighbors, so the finish is always reached.
+  std::vector<uint> route;
+  for(uint node = finishNode; node != startNode; node = parents[node]) {
+    route.push_back(node);
+  }
+  route.push_back(startNode);
+  std::reverse(route.begin(), route.end());
+
+  // Refine each abstract edge into moves.
+  std::vector<Direction::T> path;
+  for(size_t i = 0; i + 1 < route.size(); ++i) {
+    const uint from = route[i];
+    const uint to = route[i + 1];
+
+    if(from == startNode) {
+      startSearch.appendPathTo(posOf(to), path);
+    } else if(to == finishNode) {
+      finishSearch.appendPathFrom(nodes[from].pos, path);
+    } else if(nodes[from].cluster == nodes[to].cluster) {
+      const uint cluster = nodes[from].cluster;
+      refineSearch.run(terrain, nodes[from].pos, clusterBottomLeft(cluster),
+                       clusterTopRight(cluster), nodes[to].pos);
+      refineSearch.appendPathTo(nodes[to].pos, path);
+      expansions += refineSearch.getExpansions();
+    } else {
+      path.push_back(directionBetween(nodes[from].pos, nodes[to].pos));
+    }
+  }
+
+  return path;
+}
+
+}  // namespace Rally
@@ -0,0 +1,737 @@
+#include "search/contraction-hierarchy.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Rally {
+
+namespace {
+
+using Edge = ContractionHierarchy::Edge;
+constexpr uint kNoMiddle = ContractionHierarchy::kNoMiddle;
+
+// How many hexes a search for a path around a contracted hex may settle. A
+// search that gives up early only adds a shortcut that wasn't needed.
+constexpr uint kWitnessSettled = 60;
+
+constexpr char kMagic[8] = {'R', 'A', 'L', 'L', 'Y', 'C', 'H', '\0'};
+
+void putLittle(std::ostream& out, uint32_t value) {
+  unsigned char bytes[4];
+  for(size_t i = 0; i < sizeof(bytes); ++i) {
+    bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+  }
+  out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+uint32_t getLittle(std::istream& in) {
+  unsigned char bytes[4];
+  if(!in.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+    throw std::invalid_argument("contraction hierarchy is truncated");
+  }
+
+  uint32_t value = 0;
+  for(size_t i = 0; i < sizeof(bytes); ++i) {
+    value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+// The direction of the move between two neighboring hexes.
+Direction::T directionBetween(const Point& from, const Point& to) {
+  for(const auto dir : Direction::kAllMoveDirections) {
+    if(from + kMoveOffsets[static_cast<size_t>(dir)] == to) {
+      return dir;
+    }
+  }
+
+  return Direction::T::eNone;
+}
+
+// Removes hexes from a graph of the map one at a time, adding the shortcuts
+// needed to keep the cheapest paths between the hexes that are left.
+class Contractor {
+  struct Shortcut {
+    uint from;
+    Edge edge;
+  };
+
+  std::vector<uint> roughness;
+  // Hexes that are ranked last and never searched through.
+  std::vector<bool> unknown;
+  // The edges to every neighbor that hasn't been contracted yet.
+  std::vector<std::vector<Edge>> graph;
+  std::vector<uint> contractedNeighbors;
+  std::vector<uint> depths;
+
+  // The neighbors of one hex, and what it costs to move to them.
+  GenerationStamps nearStamps;
+  std::vector<uint> nearCosts;
+
+  GenerationStamps stamps;
+  GenerationStamps targetStamps;
+  std::vector<uint> costs;
+  ReusableHeap<std::pair<uint, uint>> frontier;
+  // The neighbors a search still has to find a path to.
+  std::vector<size_t> pending;
+  std::vector<Shortcut> shortcuts;
+
+  // Marks the neighbors of `from` with the cost of moving to them.
+  void markNeighbors(uint from);
+  // Whether there's a path of one or two edges from the hex marked by
+  // `markNeighbors` to `to` that doesn't go through `hex` and costs no more
+  // than `cost`.
+  bool hasShortPath(uint hex, uint to, uint cost) const;
+  // Searches for the cheapest paths from the neighbor of `hex` at `first` to
+  // the neighbors in `pending`, without going through `hex`.
+  void searchAround(uint hex, size_t first);
+  // Finds the shortcuts needed to contract the hex.
+  void findShortcuts(uint hex);
+  // Counts the shortcuts the hex would need, only looking for paths around it
+  // of one or two edges.
+  uint countShortcuts(uint hex);
+  void addEdge(uint from, const Edge& edge);
+
+ public:
+  explicit Contractor(const TerrainCache& terrain);
+
+  // How worthwhile it is to contract the hex next. Lower is better.
+  int priority(uint hex);
+  // Contracts the hex, and returns its edges to the hexes still left.
+  std::vector<Edge> contract(uint hex);
+
+  inline bool isUnknown(uint hex) const { return unknown[hex]; }
+};
+
+Contractor::Contractor(const TerrainCache& terrain) {
+  const int width = terrain.getWidth();
+  const int height = terrain.getHeight();
+  const size_t size = static_cast<size_t>(width) * height;
+
+  roughness.resize(size);
+  unknown.assign(size, false);
+  graph.resize(size);
+  contractedNeighbors.assign(size, 0);
+  depths.assign(size, 0);
+  nearCosts.resize(size);
+  costs.resize(size);
+
+  for(const Point& pos : terrain.getUnknown()) {
+    unknown[terrain.index(pos)] = true;
+  }
+
+  for(int y = 0; y < height; ++y) {
+    for(int x = 0; x < width; ++x) {
+      const Point pos = {x, y};
+      const size_t hex = terrain.index(pos);
+      roughness[hex] = terrain.getRoughness(pos);
+
+      for(const auto dir : Direction::kAllMoveDirections) {
+        const Point near = pos + kMoveOffsets[static_cast<size_t>(dir)];
+        if(terrain.inBounds(near)) {
+          graph[hex].push_back(
+              Edge{static_cast<uint>(terrain.index(near)), 0, kNoMiddle});
+        }
+      }
+    }
+  }
+}
+
+// Marks the neighbors of `from` with the cost of moving to them.
+void Contractor::markNeighbors(uint from) {
+  nearStamps.reset(graph.size());
+  for(const Edge& edge : graph[from]) {
+    nearStamps.mark(edge.to);
+    nearCosts[edge.to] = edge.cost + roughness[from] + roughness[edge.to];
+  }
+}
+
+// Whether there's a path of one or two edges from the hex marked by
+// `markNeighbors` to `to` that doesn't go through `hex` and costs no more
+// than `cost`.
+bool Contractor::hasShortPath(uint hex, uint to, uint cost) const {
+  if(nearStamps.isMarked(to) && nearCosts[to] <= cost) {
+    return true;
+  }
+
+  for(const Edge& edge : graph[to]) {
+    const uint near = edge.to;
+    if(near != hex && !unknown[near] && nearStamps.isMarked(near) &&
+       nearCosts[near] + edge.cost + roughness[near] + roughness[to] <= cost) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Searches for the cheapest paths from the neighbor of `hex` at `first` to
+// the neighbors in `pending`, without going through `hex`. The search stops
+// once every path that could replace a shortcut is found.
+void Contractor::searchAround(uint hex, size_t first) {
+  const std::vector<Edge>& around = graph[hex];
+  const uint source = around[first].to;
+  stamps.reset(graph.size());
+  targetStamps.reset(graph.size());
+
+  uint limit = 0;
+  for(const size_t i : pending) {
+    targetStamps.mark(around[i].to);
+    limit = std::max(limit, around[first].cost + around[i].cost +
+                                roughness[source] + 2 * roughness[hex] +
+                                roughness[around[i].to]);
+  }
+
+  stamps.mark(source);
+  costs[source] = 0;
+  frontier.clear();
+  frontier.push({0, source});
+
+  uint targets = pending.size();
+  for(uint settled = 0; !frontier.empty() && settled < kWitnessSettled;
+      ++settled) {
+    const uint frontCost = frontier.top().first;
+    const uint front = frontier.top().second;
+    frontier.pop();
+
+    if(frontCost != costs[front]) {
+      --settled;
+      continue;
+    }
+    if(frontCost > limit) {
+      break;
+    }
+    if(targetStamps.isMarked(front) && --targets == 0) {
+      break;
+    }
+
+    // Paths may end at a hex that isn't known, but never go through one.
+    if(unknown[front] && front != source) {
+      continue;
+    }
+
+    for(const Edge& edge : graph[front]) {
+      if(edge.to == hex) {
+        continue;
+      }
+
+      const uint cost =
+          frontCost + edge.cost + roughness[front] + roughness[edge.to];
+      if(!stamps.isMarked(edge.to) || cost < costs[edge.to]) {
+        stamps.mark(edge.to);
+        costs[edge.to] = cost;
+        frontier.push({cost, edge.to});
+      }
+    }
+  }
+}
+
+// Finds the shortcuts needed to contract the hex. Most pairs of neighbors
+// have a path of one or two edges between them, and only the rest need a
+// search.
+void Contractor::findShortcuts(uint hex) {
+  shortcuts.clear();
+  const std::vector<Edge>& around = graph[hex];
+
+  for(size_t i = 0; i + 1 < around.size(); ++i) {
+    const uint from = around[i].to;
+    markNeighbors(from);
+
+    pending.clear();
+    for(size_t j = i + 1; j < around.size(); ++j) {
+      const uint to = around[j].to;
+      const uint cost = around[i].cost + around[j].cost + roughness[from] +
+                        2 * roughness[hex] + roughness[to];
+      if(!hasShortPath(hex, to, cost)) {
+        pending.push_back(j);
+      }
+    }
+
+    if(pending.empty()) {
+      continue;
+    }
+    searchAround(hex, i);
+
+    for(const size_t j : pending) {
+      const uint to = around[j].to;
+      const uint cost = around[i].cost + around[j].cost + 2 * roughness[hex];
+
+      if(!stamps.isMarked(to) ||
+         costs[to] > cost + roughness[from] + roughness[to]) {
+        shortcuts.push_back(Shortcut{from, Edge{to, cost, hex}});
+      }
+    }
+  }
+}
+
+// Counts the shortcuts the hex would need, only looking for paths around it
+// of one or two edges. That misses some longer paths, but it's far quicker
+// than searching, and close enough to decide which hex to contract next.
+uint Contractor::countShortcuts(uint hex) {
+  const std::vector<Edge>& around = graph[hex];
+  uint count = 0;
+
+  for(size_t i = 0; i + 1 < around.size(); ++i) {
+    const uint from = around[i].to;
+    markNeighbors(from);
+
+    for(size_t j = i + 1; j < around.size(); ++j) {
+      const uint to = around[j].to;
+      const uint cost = around[i].cost + around[j].cost + roughness[from] +
+                        2 * roughness[hex] + roughness[to];
+      if(!hasShortPath(hex, to, cost)) {
+        ++count;
+      }
+    }
+  }
+
+  return count;
+}
+
+// Adds an edge, or lowers the cost of the edge that's already there.
+void Contractor::addEdge(uint from, const Edge& edge) {
+  for(Edge& existing : graph[from]) {
+    if(existing.to == edge.to) {
+      if(edge.cost < existing.cost) {
+        existing = edge;
+      }
+      return;
+    }
+  }
+
+  graph[from].push_back(edge);
+}
+
+// How worthwhile it is to contract the hex next. Lower is better. Hexes that
+// add few edges go first, spread out over the map, so the hierarchy stays
+// shallow.
+int Contractor::priority(uint hex) {
+  return 4 * (static_cast<int>(countShortcuts(hex)) -
+              static_cast<int>(graph[hex].size())) +
+         2 * static_cast<int>(contractedNeighbors[hex]) +
+         4 * static_cast<int>(depths[hex]);
+}
+
+// Contracts the hex, and returns its edges to the hexes still left.
+std::vector<Edge> Contractor::contract(uint hex) {
+  if(!unknown[hex]) {
+    findShortcuts(hex);
+  } else {
+    shortcuts.clear();
+  }
+
+  for(const Edge& edge : graph[hex]) {
+    std::vector<Edge>& back = graph[edge.to];
+    for(size_t i = 0; i < back.size(); ++i) {
+      if(back[i].to == hex) {
+        back[i] = back.back();
+        back.pop_back();
+        break;
+      }
+    }
+
+    ++contractedNeighbors[edge.to];
+    depths[edge.to] = std::max(depths[edge.to], depths[hex] + 1);
+  }
+
+  for(const Shortcut& shortcut : shortcuts) {
+    addEdge(shortcut.from, shortcut.edge);
+    addEdge(shortcut.edge.to,
+            Edge{shortcut.from, shortcut.edge.cost, shortcut.edge.middle});
+  }
+
+  std::vector<Edge> up;
+  up.swap(graph[hex]);
+  return up;
+}
+
+}  // namespace
+
+ContractionHierarchy::ContractionHierarchy() : width(0), height(0) {}
+
+// Contracts every hex of the cache. The hexes the cache doesn't know the
+// roughness of yet are ranked last.
+void ContractionHierarchy::build(const TerrainCache& terrain) {
+  width = terrain.getWidth();
+  height = terrain.getHeight();
+  const uint size = width * height;
+
+  Contractor contractor(terrain);
+  std::vector<std::vector<Edge>> upEdges(size);
+  std::vector<int> priorities(size);
+  std::vector<bool> stale(size, false);
+  hexes.clear();
+  hexes.reserve(size);
+
+  // A hex's priority only changes when one of its neighbors is contracted.
+  // It's only worked out again once the hex comes out on top, and then it's
+  // put back if it got worse than the next one.
+  ReusableHeap<std::pair<int, uint>> queue;
+  for(uint hex = 0; hex < size; ++hex) {
+    if(!contractor.isUnknown(hex)) {
+      priorities[hex] = contractor.priority(hex);
+      queue.push({priorities[hex], hex});
+    }
+  }
+
+  while(!queue.empty()) {
+    const uint hex = queue.top().second;
+    const int oldPriority = queue.top().first;
+    queue.pop();
+
+    if(oldPriority != priorities[hex]) {
+      continue;
+    }
+
+    if(stale[hex]) {
+      stale[hex] = false;
+      priorities[hex] = contractor.priority(hex);
+      if(!queue.empty() && priorities[hex] > queue.top().first) {
+        queue.push({priorities[hex], hex});
+        continue;
+      }
+    }
+
+    // Marks the hex as taken, so stale entries for it are skipped.
+    priorities[hex] = INT32_MIN;
+    hexes.push_back(hex);
+    upEdges[hex] = contractor.contract(hex);
+
+    for(const Edge& edge : upEdges[hex]) {
+      stale[edge.to] = true;
+    }
+  }
+
+  for(const Point& pos : terrain.getUnknown()) {
+    const uint hex = terrain.index(pos);
+    hexes.push_back(hex);
+    upEdges[hex] = contractor.contract(hex);
+  }
+
+  ranks.resize(size);
+  roughness.resize(size);
+  for(uint rank = 0; rank < size; ++rank) {
+    ranks[hexes[rank]] = rank;
+    roughness[rank] = terrain.getRoughness(
+        Point{static_cast<int>(hexes[rank] % width),
+              static_cast<int>(hexes[rank] / width)});
+  }
+
+  firstEdges.assign(size + 1, 0);
+  edges.clear();
+  for(uint rank = 0; rank < size; ++rank) {
+    firstEdges[rank] = edges.size();
+
+    for(const Edge& edge : upEdges[hexes[rank]]) {
+      edges.push_back(Edge{ranks[edge.to], edge.cost,
+                           edge.middle == kNoMiddle ? kNoMiddle
+                                                    : ranks[edge.middle]});
+    }
+    std::vector<Edge>().swap(upEdges[hexes[rank]]);
+  }
+  firstEdges[size] = edges.size();
+}
+
+// Takes the roughness of hexes the cache has learned since the hierarchy was
+// built. Those were ranked last, so no shortcut depends on them.
+void ContractionHierarchy::update(const TerrainCache& terrain,
+                                  const std::vector<Point>& changed) {
+  for(const Point& pos : changed) {
+    roughness[getRank(pos)] = terrain.getRoughness(pos);
+  }
+}
+
+// Finds the edge of `low` to `high`.
+const Edge& ContractionHierarchy::findEdge(uint low, uint high) const {
+  for(uint i = firstEdges[low]; i < firstEdges[low + 1]; ++i) {
+    if(edges[i].to == high) {
+      return edges[i];
+    }
+  }
+
+  throw std::logic_error("contraction hierarchy is missing an edge");
+}
+
+// Appends the ranks along an edge of `low`, not including the first. They go
+// from `low` to the end of the edge, or back if `downwards` is set.
+void ContractionHierarchy::appendRanks(uint low,
+                                       const Edge& edge,
+                                       bool downwards,
+                                       std::vector<uint>& out) const {
+  if(edge.middle == kNoMiddle) {
+    out.push_back(downwards ? low : edge.to);
+    return;
+  }
+
+  // The middle was contracted before both ends, so it holds the edges to
+  // either of them.
+  const Edge& toLow = findEdge(edge.middle, low);
+  const Edge& toHigh = findEdge(edge.middle, edge.to);
+
+  if(downwards) {
+    appendRanks(edge.middle, toHigh, true, out);
+    appendRanks(edge.middle, toLow, false, out);
+  } else {
+    appendRanks(edge.middle, toLow, true, out);
+    appendRanks(edge.middle, toHigh, false, out);
+  }
+}
+
+// Writes the hierarchy in a binary format. Every number is little endian.
+// Throws an exception if the stream can't be written to.
+void ContractionHierarchy::write(std::ostream& out) const {
+  out.write(kMagic, sizeof(kMagic));
+  putLittle(out, kVersion);
+  putLittle(out, width);
+  putLittle(out, height);
+  putLittle(out, edges.size());
+
+  for(const uint hex : hexes) {
+    putLittle(out, hex);
+  }
+  out.write(reinterpret_cast<const char*>(roughness.data()),
+            roughness.size());
+  for(size_t rank = 0; rank < hexes.size(); ++rank) {
+    putLittle(out, firstEdges[rank + 1] - firstEdges[rank]);
+  }
+  for(const Edge& edge : edges) {
+    putLittle(out, edge.to);
+    putLittle(out, edge.cost);
+    putLittle(out, edge.middle);
+  }
+
+  if(!out) {
+    throw std::runtime_error("could not write contraction hierarchy");
+  }
+}
+
+// Reads a hierarchy written by `write`. Throws an exception if the stream
+// doesn't hold a valid hierarchy.
+void ContractionHierarchy::read(std::istream& in) {
+  char magic[sizeof(kMagic)];
+  if(!in.read(magic, sizeof(magic)) ||
+     std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    throw std::invalid_argument("not a contraction hierarchy");
+  }
+  if(getLittle(in) != kVersion) {
+    throw std::invalid_argument(
+        "contraction hierarchy has an unsupported version");
+  }
+
+  const uint newWidth = getLittle(in);
+  const uint newHeight = getLittle(in);
+  const uint numEdges = getLittle(in);
+  const uint64_t size = static_cast<uint64_t>(newWidth) * newHeight;
+  if(size > UINT32_MAX / 2) {
+    throw std::invalid_argument("contraction hierarchy is too large");
+  }
+
+  std::vector<uint> newHexes(size);
+  std::vector<uint> newRanks(size, UINT32_MAX);
+  for(uint rank = 0; rank < size; ++rank) {
+    newHexes[rank] = getLittle(in);
+    if(newHexes[rank] >= size || newRanks[newHexes[rank]] != UINT32_MAX) {
+      throw std::invalid_argument("contraction hierarchy has invalid ranks");
+    }
+    newRanks[newHexes[rank]] = rank;
+  }
+
+  std::vector<unsigned char> newRoughness(size);
+  if(!in.read(reinterpret_cast<char*>(newRoughness.data()), size)) {
+    throw std::invalid_argument("contraction hierarchy is truncated");
+  }
+  for(const unsigned char value : newRoughness) {
+    if(value < 1 || value > kMaxRoughness) {
+      throw std::invalid_argument(
+          "contraction hierarchy has invalid roughness");
+    }
+  }
+
+  std::vector<uint> newFirstEdges(size + 1, 0);
+  for(size_t rank = 0; rank < size; ++rank) {
+    const uint count = getLittle(in);
+    if(count > numEdges - newFirstEdges[rank]) {
+      throw std::invalid_argument("contraction hierarchy has invalid edges");
+    }
+    newFirstEdges[rank + 1] = newFirstEdges[rank] + count;
+  }
+  if(newFirstEdges[size] != numEdges) {
+    throw std::invalid_argument("contraction hierarchy has invalid edges");
+  }
+
+  std::vector<Edge> newEdges(numEdges);
+  for(uint rank = 0; rank < size; ++rank) {
+    for(uint i = newFirstEdges[rank]; i < newFirstEdges[rank + 1]; ++i) {
+      Edge& edge = newEdges[i];
+      edge.to = getLittle(in);
+      edge.cost = getLittle(in);
+      edge.middle = getLittle(in);
+
+      // Every edge has to go up, and every shortcut has to be around a lower
+      // rank than both ends, so unpacking a path always ends.
+      if(edge.to >= size || edge.to <= rank ||
+         (edge.middle != kNoMiddle && edge.middle >= rank)) {
+        throw std::invalid_argument(
+            "contraction hierarchy has invalid edges");
+      }
+    }
+  }
+
+  width = newWidth;
+  height = newHeight;
+  hexes = std::move(newHexes);
+  ranks = std::move(newRanks);
+  roughness = std::move(newRoughness);
+  firstEdges = std::move(newFirstEdges);
+  edges = std::move(newEdges);
+
+  // A shortcut can only be unpacked if the middle has edges to both ends.
+  for(uint rank = 0; rank < size; ++rank) {
+    for(uint i = firstEdges[rank]; i < firstEdges[rank + 1]; ++i) {
+      if(edges[i].middle != kNoMiddle) {
+        findEdge(edges[i].middle, rank);
+        findEdge(edges[i].middle, edges[i].to);
+      }
+    }
+  }
+}
+
+HierarchyQuery::HierarchyQuery() : source(0), target(0), expansions(0) {}
+
+// Settles the next rank of `side`, and returns the cost of the cheapest path
+// through it to the end of `other`, or `UINT32_MAX` if there isn't one yet.
+uint HierarchyQuery::step(const ContractionHierarchy& hierarchy,
+                          Side& side,
+                          const Side& other) {
+  const uint frontCost = side.frontier.top().first;
+  const uint front = side.frontier.top().second;
+  side.frontier.pop();
+
+  if(frontCost != side.costs[front]) {
+    return UINT32_MAX;
+  }
+
+  ++expansions;
+
+  const uint frontRoughness = roughnessOf(hierarchy, front);
+  const uint first = hierarchy.firstEdges[front];
+  const uint last = hierarchy.firstEdges[front + 1];
+  const uint through = other.stamps.isMarked(front)
+                           ? frontCost + other.costs[front]
+                           : UINT32_MAX;
+
+  // If a higher rank already has a cheaper way here, the cheapest path to
+  // this rank comes down from above, so no cheapest path goes up from it.
+  for(uint i = first; i < last; ++i) {
+    const Edge& edge = hierarchy.edges[i];
+    if(side.stamps.isMarked(edge.to) &&
+       side.costs[edge.to] + edge.cost + frontRoughness +
+               roughnessOf(hierarchy, edge.to) <
+           frontCost) {
+      return through;
+    }
+  }
+
+  for(uint i = first; i < last; ++i) {
+    const Edge& edge = hierarchy.edges[i];
+    const uint cost = frontCost + edge.cost + frontRoughness +
+                      roughnessOf(hierarchy, edge.to);
+
+    if(!side.stamps.isMarked(edge.to) || cost < side.costs[edge.to]) {
+      side.stamps.mark(edge.to);
+      side.costs[edge.to] = cost;
+      side.parents[edge.to] = {front, i};
+      side.frontier.push({cost, edge.to});
+    }
+  }
+
+  return through;
+}
+
+// Finds the cheapest path from `start` to `finish`, where the two count as
+// having a roughness of one like the start and finish of a race.
+std::vector<Direction::T> HierarchyQuery::findPath(
+    const ContractionHierarchy& hierarchy,
+    Point start,
+    Point finish) {
+  const size_t size = hierarchy.hexes.size();
+  for(Side* side : {&forward, &backward}) {
+    if(side->costs.size() < size) {
+      side->costs.resize(size);
+      side->parents.resize(size);
+    }
+    side->stamps.reset(size);
+    side->frontier.clear();
+  }
+
+  source = hierarchy.getRank(start);
+  target = hierarchy.getRank(finish);
+  expansions = 0;
+  for(auto end : {std::make_pair(&forward, source),
+                  std::make_pair(&backward, target)}) {
+    end.first->stamps.mark(end.second);
+    end.first->costs[end.second] = 0;
+    end.first->frontier.push({0, end.second});
+  }
+
+  uint best = UINT32_MAX;
+  uint meet = source;
+  while(true) {
+    const bool forwardLeft =
+        !forward.frontier.empty() && forward.frontier.top().first < best;
+    const bool backwardLeft =
+        !backward.frontier.empty() && backward.frontier.top().first < best;
+    if(!forwardLeft && !backwardLeft) {
+      break;
+    }
+
+    const bool goForward =
+        forwardLeft && (!backwardLeft || forward.frontier.top().first <=
+                                             backward.frontier.top().first);
+    const uint rank = goForward ? forward.frontier.top().second
+                                : backward.frontier.top().second;
+    const uint cost = goForward ? step(hierarchy, forward, backward)
+                                : step(hierarchy, backward, forward);
+    if(cost < best) {
+      best = cost;
+      meet = rank;
+    }
+  }
+
+  std::vector<Direction::T> path;
+  if(best == UINT32_MAX) {
+    return path;
+  }
+
+  // The ranks from the start are found backwards, from where the two sides
+  // met.
+  ranks.clear();
+  ranks.push_back(meet);
+  for(uint rank = meet; rank != source; rank = forward.parents[rank].first) {
+    const auto& up = forward.parents[rank];
+    hierarchy.appendRanks(up.first, hierarchy.edges[up.second], true, ranks);
+  }
+  std::reverse(ranks.begin(), ranks.end());
+
+  for(uint rank = meet; rank != target; rank = backward.parents[rank].first) {
+    const auto& down = backward.parents[rank];
+    hierarchy.appendRanks(down.first, hierarchy.edges[down.second], true,
+                          ranks);
+  }
+
+  const uint width = hierarchy.getWidth();
+  const auto pointOf = [&](uint rank) {
+    const uint hex = hierarchy.hexes[rank];
+    return Point{static_cast<int>(hex % width), static_cast<int>(hex / width)};
+  };
+
+  path.reserve(ranks.size() - 1);
+  for(size_t i = 1; i < ranks.size(); ++i) {
+    path.push_back(directionBetween(pointOf(ranks[i - 1]), pointOf(ranks[i])));
+  }
+
+  return path;
+}
+
+}  // namespace Rally
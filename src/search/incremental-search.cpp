@@ -0,0 +1,250 @@
+#include "search/incremental-search.h"
+
+#include <algorithm>
+
+namespace Rally {
+
+constexpr uint IncrementalSearch::kUnreached;
+constexpr uint64_t IncrementalSearch::kNotQueued;
+
+namespace {
+
+// Every move costs at least two, so this never overestimates.
+inline uint hueristic(const Point& a, const Point& b) {
+  return a.distanceTo(b) * 2;
+}
+
+}  // namespace
+
+IncrementalSearch::IncrementalSearch()
+    : width(0),
+      height(0),
+      start({-1, -1}),
+      finish({-1, -1}),
+      keyModifier(0),
+      expansions(0) {}
+
+// Ordered by the smaller of the cost and lookahead plus a lower bound on the
+// cost to the start, and then by the smaller of the cost and lookahead.
+uint64_t IncrementalSearch::keyOf(size_t hex) const {
+  const uint cost = std::min(costs[hex], lookaheads[hex]);
+  if(cost == kUnreached) {
+    return kNotQueued;
+  }
+
+  const uint estimate = cost + hueristic(pointAt(hex), start) + keyModifier;
+
+  return (static_cast<uint64_t>(estimate) << 32) | cost;
+}
+
+// The cheapest way from the hex to the finish through one of its neighbors.
+uint IncrementalSearch::lookaheadOf(const Point& pos) const {
+  const uint posRoughness = roughnessOf(pos);
+
+  uint best = kUnreached;
+  for(const auto& offset : kMoveOffsets) {
+    const Point near = pos + offset;
+    if(near == pos || !near.inBounds(0, 0, width, height)) {
+      continue;
+    }
+
+    const uint nearCost = costs[index(near)];
+    if(nearCost != kUnreached) {
+      best = std::min(best, nearCost + posRoughness + roughnessOf(near));
+    }
+  }
+
+  return best;
+}
+
+// Queues the hex if its cost and lookahead differ, and takes it out of the
+// queue otherwise.
+void IncrementalSearch::queue(size_t hex) {
+  if(costs[hex] == lookaheads[hex]) {
+    queuedKeys[hex] = kNotQueued;
+    return;
+  }
+
+  const uint64_t key = keyOf(hex);
+  if(key != queuedKeys[hex]) {
+    queuedKeys[hex] = key;
+    frontier.push({key, static_cast<uint>(hex)});
+  }
+}
+
+// Finds the lookahead of the hex and its neighbors again, after the cost of
+// moving to or from the hex changed.
+void IncrementalSearch::updateAround(const Point& pos) {
+  // The offsets include staying put, so the hex itself is updated as well.
+  for(const auto& offset : kMoveOffsets) {
+    const Point near = pos + offset;
+    if(!near.inBounds(0, 0, width, height) || near == finish) {
+      continue;
+    }
+
+    const size_t nearIndex = index(near);
+    lookaheads[nearIndex] = lookaheadOf(near);
+    queue(nearIndex);
+  }
+}
+
+// Settles hexes until the cost of the start is known.
+void IncrementalSearch::computeCosts() {
+  const size_t startIndex = index(start);
+
+  while(true) {
+    // Entries whose hex has been queued again since are skipped.
+    while(!frontier.empty() &&
+          frontier.top().first != queuedKeys[frontier.top().second]) {
+      frontier.pop();
+    }
+
+    if(frontier.empty()) {
+      return;
+    }
+
+    const uint64_t key = frontier.top().first;
+    if(key >= keyOf(startIndex) &&
+       costs[startIndex] == lookaheads[startIndex]) {
+      return;
+    }
+
+    const size_t hex = frontier.top().second;
+    frontier.pop();
+    queuedKeys[hex] = kNotQueued;
+
+    // The key is out of date because the start has moved since.
+    const uint64_t newKey = keyOf(hex);
+    if(key < newKey) {
+      queuedKeys[hex] = newKey;
+      frontier.push({newKey, static_cast<uint>(hex)});
+      continue;
+    }
+
+    ++expansions;
+
+    const Point pos = pointAt(hex);
+    if(costs[hex] > lookaheads[hex]) {
+      // The hex got cheaper, which can only make its neighbors cheaper.
+      costs[hex] = lookaheads[hex];
+
+      for(const auto& offset : kMoveOffsets) {
+        const Point near = pos + offset;
+        if(near == pos || !near.inBounds(0, 0, width, height) ||
+           near == finish) {
+          continue;
+        }
+
+        const size_t nearIndex = index(near);
+        lookaheads[nearIndex] =
+            std::min(lookaheads[nearIndex],
+                     costs[hex] + roughnessOf(pos) + roughnessOf(near));
+        queue(nearIndex);
+      }
+    } else {
+      // The hex got more expensive, so it and every neighbor that went
+      // through it have to look for a new way.
+      costs[hex] = kUnreached;
+      updateAround(pos);
+    }
+  }
+}
+
+// Forgets everything, and starts a new search between the given end points
+// with the roughness of the cache.
+void IncrementalSearch::reset(const TerrainCache& terrain,
+                              Point nStart,
+                              Point nFinish) {
+  width = terrain.getWidth();
+  height = terrain.getHeight();
+  start = nStart;
+  finish = nFinish;
+  keyModifier = 0;
+
+  const size_t size = static_cast<size_t>(width) * height;
+  roughness.resize(size);
+  for(int y = 0; y < static_cast<int>(height); ++y) {
+    for(int x = 0; x < static_cast<int>(width); ++x) {
+      roughness[index({x, y})] =
+          static_cast<unsigned char>(terrain.getRoughness({x, y}));
+    }
+  }
+
+  costs.assign(size, kUnreached);
+  lookaheads.assign(size, kUnreached);
+  queuedKeys.assign(size, kNotQueued);
+  frontier.clear();
+
+  const size_t finishIndex = index(finish);
+  lookaheads[finishIndex] = 0;
+  queue(finishIndex);
+}
+
+// Reports a change in the roughness of a hex.
+void IncrementalSearch::setRoughness(Point pos, uint nRoughness) {
+  unsigned char& value = roughness[index(pos)];
+  if(value == nRoughness) {
+    return;
+  }
+
+  value = static_cast<unsigned char>(nRoughness);
+  updateAround(pos);
+}
+
+// Moves the start. The finish can't be moved without starting over.
+void IncrementalSearch::setStart(Point pos) {
+  if(pos == start) {
+    return;
+  }
+
+  const Point oldStart = start;
+  keyModifier += hueristic(oldStart, pos);
+  start = pos;
+
+  // The old start counts with its own roughness again, and the new start
+  // counts as one.
+  updateAround(oldStart);
+  updateAround(start);
+}
+
+// Finds the cheapest path from the start to the finish, repairing the search
+// after any changes since the last path.
+std::vector<Direction::T> IncrementalSearch::findPath() {
+  expansions = 0;
+  computeCosts();
+
+  // Every hex with a settled cost has a neighbor it's that much more than,
+  // on the way to the finish.
+  std::vector<Direction::T> path;
+  Point pos = start;
+  while(pos != finish) {
+    const uint posRoughness = roughnessOf(pos);
+
+    Direction::T bestDir = Direction::T::eNone;
+    uint best = kUnreached;
+    for(const auto dir : Direction::kAllMoveDirections) {
+      const Point near = pos + kMoveOffsets[static_cast<size_t>(dir)];
+      if(!near.inBounds(0, 0, width, height)) {
+        continue;
+      }
+
+      const uint nearCost = costs[index(near)];
+      if(nearCost != kUnreached &&
+         nearCost + posRoughness + roughnessOf(near) < best) {
+        best = nearCost + posRoughness + roughnessOf(near);
+        bestDir = dir;
+      }
+    }
+
+    if(bestDir == Direction::T::eNone) {
+      break;
+    }
+
+    path.push_back(bestDir);
+    pos = pos + kMoveOffsets[static_cast<size_t>(bestDir)];
+  }
+
+  return path;
+}
+
+}  // namespace Rally
@@ -0,0 +1,91 @@
+#include "search/landmarks.h"
+
+namespace Rally {
+
+Landmarks::Landmarks(uint nCount)
+    : count(nCount), width(0), height(0), frontier(kMaxRoughness * 2) {}
+
+// Finds the cost from `source` to every hex into `searchCosts`.
+void Landmarks::search(Point source) {
+  searchCosts.assign(roughness.size(), UINT32_MAX);
+  searchCosts[index(source)] = 0;
+
+  frontier.clear();
+  frontier.push(0, static_cast<uint>(index(source)));
+
+  while(!frontier.empty()) {
+    const uint frontCost = frontier.topKey();
+    const uint front = frontier.top();
+    frontier.pop();
+
+    if(frontCost != searchCosts[front]) {
+      continue;
+    }
+
+    const Point frontPoint = {static_cast<int>(front % width),
+                              static_cast<int>(front / width)};
+
+    for(const auto dir : Direction::kAllMoveDirections) {
+      const Point nearPoint =
+          frontPoint + kMoveOffsets[static_cast<size_t>(dir)];
+      if(!nearPoint.inBounds(0, 0, width, height)) {
+        continue;
+      }
+
+      const size_t near = index(nearPoint);
+      const uint cost = frontCost + roughness[front] + roughness[near];
+
+      if(cost < searchCosts[near]) {
+        searchCosts[near] = cost;
+        frontier.push(cost, static_cast<uint>(near));
+      }
+    }
+  }
+}
+
+// Picks the landmarks for the terrain of the cache, and builds their tables.
+void Landmarks::build(const TerrainCache& terrain) {
+  width = terrain.getWidth();
+  height = terrain.getHeight();
+
+  const size_t size = static_cast<size_t>(width) * height;
+  roughness.resize(size);
+  for(int y = 0; y < static_cast<int>(height); ++y) {
+    for(int x = 0; x < static_cast<int>(width); ++x) {
+      roughness[index({x, y})] =
+          static_cast<unsigned char>(terrain.getRoughness({x, y}));
+    }
+  }
+
+  const size_t numLandmarks = std::min<size_t>(count, size);
+  landmarks.clear();
+  costs.assign(size * numLandmarks, 0);
+
+  // The cost from the nearest landmark picked so far to every hex. The first
+  // landmark is the hex farthest from a corner, and the corner itself is
+  // forgotten after that.
+  search({0, 0});
+  std::vector<uint> nearest = searchCosts;
+
+  for(size_t i = 0; i < numLandmarks; ++i) {
+    size_t farthest = 0;
+    for(size_t hex = 1; hex < size; ++hex) {
+      if(nearest[hex] > nearest[farthest]) {
+        farthest = hex;
+      }
+    }
+
+    const Point landmark = {static_cast<int>(farthest % width),
+                            static_cast<int>(farthest / width)};
+    landmarks.push_back(landmark);
+
+    search(landmark);
+    for(size_t hex = 0; hex < size; ++hex) {
+      costs[hex * numLandmarks + i] = searchCosts[hex];
+      nearest[hex] =
+          i == 0 ? searchCosts[hex] : std::min(nearest[hex], searchCosts[hex]);
+    }
+  }
+}
+
+}  // namespace Rally
@@ -0,0 +1,183 @@
+#include "search/terrain-cache.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace Rally {
+
+TerrainCache::TerrainCache(bool nFollowsEdits)
+    : followsEdits(nFollowsEdits),
+      terrainId(0),
+      width(0),
+      height(0),
+      start({-1, -1}),
+      finish({-1, -1}) {}
+
+void TerrainCache::learnAll(MapInterface* api) {
+  roughness.assign(static_cast<size_t>(width) * height, 0);
+  unknown.clear();
+
+  // Moving off the map costs twice the roughness of the hex, which gives the
+  // first hex. Every other hex follows from the cost of moving onto it from a
+  // hex that is already known.
+  roughness[0] = api->getMoveCost({0, 0}, Direction::T::eSouthWest) / 2;
+
+  for(int x = 1; x < static_cast<int>(width); ++x) {
+    roughness[x] = api->getMoveCost({x - 1, 0}, Direction::T::eNorthEast) -
+                   roughness[x - 1];
+  }
+
+  for(int y = 1; y < static_cast<int>(height); ++y) {
+    for(int x = 0; x < static_cast<int>(width); ++x) {
+      const size_t above = index({x, y - 1});
+      roughness[above + width] =
+          api->getMoveCost({x, y - 1}, Direction::T::eSouthEast) -
+          roughness[above];
+    }
+  }
+
+  unknown.push_back(start);
+  unknown.push_back(finish);
+}
+
+// Learns a single hex with one map look. Returns false if it can't be
+// learned yet, because none of its neighbors are known.
+bool TerrainCache::learnHex(MapInterface* api, Point pos, uint& value) const {
+  // Moving off of the map only involves the hex itself.
+  for(const auto dir : Direction::kAllMoveDirections) {
+    if(api->getDestination(pos, dir) == pos) {
+      value = api->getMoveCost(pos, dir) / 2;
+      return true;
+    }
+  }
+
+  // Away from the edge there are six neighbors. Without edits at most four of
+  // them are an end point or not known yet.
+  for(const auto dir : Direction::kAllMoveDirections) {
+    const Point near = pos + kMoveOffsets[static_cast<size_t>(dir)];
+
+    if(near == start || near == finish ||
+       std::find(unknown.begin(), unknown.end(), near) != unknown.end() ||
+       std::find(pending.begin(), pending.end(), near) != pending.end()) {
+      continue;
+    }
+
+    value = api->getMoveCost(pos, dir) - roughness[index(near)];
+    return true;
+  }
+
+  return false;
+}
+
+// Learns the hexes edited since the cached terrain again. Returns false if
+// the map doesn't know what was edited, or if some of the edited hexes can't
+// be learned on their own.
+bool TerrainCache::learnEdits(MapInterface* api, std::vector<Point>& changed) {
+  pending.clear();
+  if(!api->getEditsSince(terrainId, pending)) {
+    return false;
+  }
+
+  std::sort(pending.begin(), pending.end(),
+            [this](const Point& a, const Point& b) {
+              return index(a) < index(b);
+            });
+  pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+  // The end points of this race can only be learned in a later race. Hexes
+  // that are already waiting for that don't need anything else.
+  std::vector<Point> edited;
+  for(const Point& pos : pending) {
+    if(std::find(unknown.begin(), unknown.end(), pos) != unknown.end()) {
+      continue;
+    }
+
+    if(pos == start || pos == finish) {
+      if(roughness[index(pos)] != 1) {
+        roughness[index(pos)] = 1;
+        changed.push_back(pos);
+      }
+
+      unknown.push_back(pos);
+    } else {
+      edited.push_back(pos);
+    }
+  }
+  pending = std::move(edited);
+
+  // Each edited hex is learned from a neighbor that is known, which for a
+  // patch of edits means working in from its edges.
+  std::vector<std::pair<Point, uint>> learned;
+  while(!pending.empty()) {
+    learned.clear();
+    for(const Point& pos : pending) {
+      uint value;
+      if(learnHex(api, pos, value)) {
+        learned.push_back({pos, value});
+      }
+    }
+
+    if(learned.empty()) {
+      pending.clear();
+      return false;
+    }
+
+    for(const auto& hex : learned) {
+      pending.erase(std::find(pending.begin(), pending.end(), hex.first));
+
+      if(hex.second != roughness[index(hex.first)]) {
+        roughness[index(hex.first)] = static_cast<unsigned char>(hex.second);
+        changed.push_back(hex.first);
+      }
+    }
+  }
+
+  return true;
+}
+
+// Brings the cache up to date with the race. Returns true if the whole map
+// had to be learned, because the cache held a different terrain. Otherwise
+// the hexes whose roughness turned out to be different from what was
+// cached are added to `changed`.
+bool TerrainCache::update(MapInterface* api, std::vector<Point>& changed) {
+  start = api->getStart();
+  finish = api->getFinish();
+
+  if(api->getWidth() != width || api->getHeight() != height ||
+     (api->getTerrainId() != terrainId &&
+      (!followsEdits || !learnEdits(api, changed)))) {
+    terrainId = api->getTerrainId();
+    width = api->getWidth();
+    height = api->getHeight();
+    learnAll(api);
+    return true;
+  }
+
+  terrainId = api->getTerrainId();
+
+  // Old end points that are still end points have to wait for another race.
+  std::vector<Point> waiting;
+  while(!unknown.empty()) {
+    const Point pos = unknown.back();
+    unknown.pop_back();
+
+    uint value;
+    if(pos == start || pos == finish || !learnHex(api, pos, value)) {
+      waiting.push_back(pos);
+      continue;
+    }
+
+    if(value != roughness[index(pos)]) {
+      roughness[index(pos)] = static_cast<unsigned char>(value);
+      changed.push_back(pos);
+    }
+  }
+
+  // The end points of this race that were already known keep their real
+  // roughness in the cache, and only look different through `getRoughness`.
+  unknown = std::move(waiting);
+
+  return false;
+}
+
+}  // namespace Rally
@@ -0,0 +1,31 @@
+#include "stats/clock.h"
+
+#include <chrono>
+#include <ctime>
+
+namespace Rally {
+
+// Nanoseconds on a monotonic clock. Only the difference between two readings
+// is meaningful.
+uint64_t wallNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Nanoseconds of CPU time used by the calling thread. Where per thread CPU
+// time isn't available this falls back to the CPU time of the whole process,
+// which is only accurate when a single thread is running races.
+uint64_t threadCpuNanos() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec time;
+  if(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0) {
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ull +
+           static_cast<uint64_t>(time.tv_nsec);
+  }
+#endif
+
+  return static_cast<uint64_t>(std::clock()) * (1000000000ull / CLOCKS_PER_SEC);
+}
+
+}  // namespace Rally
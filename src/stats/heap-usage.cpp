@@ -0,0 +1,166 @@
+#include "stats/heap-usage.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Every allocation is prefixed with its size so it can be taken off the count
+// when freed. The prefix keeps the rest of the block aligned as `malloc` would.
+constexpr size_t kHeaderSize = alignof(std::max_align_t) > sizeof(size_t)
+                                   ? alignof(std::max_align_t)
+                                   : sizeof(size_t);
+
+thread_local int64_t threadLiveBytes = 0;
+thread_local int64_t threadPeakBytes = 0;
+thread_local uint64_t threadAllocations = 0;
+thread_local uint64_t threadAllocatedBytes = 0;
+
+#ifdef RALLY_HEAP_STATS
+
+void* allocate(size_t size) noexcept {
+  char* const block = static_cast<char*>(std::malloc(size + kHeaderSize));
+  if(block == nullptr) {
+    return nullptr;
+  }
+
+  *reinterpret_cast<size_t*>(block) = size;
+  threadLiveBytes += size;
+  threadPeakBytes = std::max(threadPeakBytes, threadLiveBytes);
+  threadAllocations += 1;
+  threadAllocatedBytes += size;
+
+  return block + kHeaderSize;
+}
+
+void deallocate(void* ptr) noexcept {
+  if(ptr == nullptr) {
+    return;
+  }
+
+  char* const block = static_cast<char*>(ptr) - kHeaderSize;
+  threadLiveBytes -= *reinterpret_cast<size_t*>(block);
+  std::free(block);
+}
+
+void* allocateOrThrow(size_t size) {
+  void* ptr;
+  while((ptr = allocate(size)) == nullptr) {
+    std::new_handler handler = std::get_new_handler();
+    if(handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+
+  return ptr;
+}
+
+#endif
+
+}  // namespace
+
+#ifdef RALLY_HEAP_STATS
+
+// Every form of the global allocation functions is replaced, so that each one
+// agrees on the size prefix. Over-aligned allocations aren't counted, and go
+// through the standard library untouched.
+void* operator new(size_t size) {
+  return allocateOrThrow(size);
+}
+
+void* operator new[](size_t size) {
+  return allocateOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  deallocate(ptr);
+}
+
+#endif
+
+namespace Rally {
+
+// Whether the allocation functions are replaced to count heap usage, which
+// only the builds configured with `HEAP_STATS` do. Without them every count
+// stays 0.
+bool heapStatsEnabled() {
+#ifdef RALLY_HEAP_STATS
+  return true;
+#else
+  return false;
+#endif
+}
+
+int64_t liveHeapBytes() {
+  return threadLiveBytes;
+}
+
+// The number of calls to `operator new` made on the calling thread, and the
+// bytes they asked for, since the thread started.
+uint64_t heapAllocations() {
+  return threadAllocations;
+}
+
+uint64_t heapAllocatedBytes() {
+  return threadAllocatedBytes;
+}
+
+HeapScope::HeapScope()
+    : startBytes(threadLiveBytes),
+      outerPeak(threadPeakBytes),
+      startAllocations(threadAllocations),
+      startAllocatedBytes(threadAllocatedBytes) {
+  threadPeakBytes = threadLiveBytes;
+}
+
+// The outer scope still sees everything that was live in this one.
+HeapScope::~HeapScope() {
+  threadPeakBytes = std::max(outerPeak, threadPeakBytes);
+}
+
+int64_t HeapScope::peakBytes() const {
+  return threadPeakBytes - startBytes;
+}
+
+// The number of allocations made since the scope was opened, whether or not
+// they were freed again.
+uint64_t HeapScope::allocations() const {
+  return threadAllocations - startAllocations;
+}
+
+uint64_t HeapScope::allocatedBytes() const {
+  return threadAllocatedBytes - startAllocatedBytes;
+}
+
+}  // namespace Rally
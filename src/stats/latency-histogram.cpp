@@ -0,0 +1,115 @@
+#include "stats/latency-histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Rally {
+
+constexpr uint64_t LatencyHistogram::kSubBits;
+constexpr uint64_t LatencyHistogram::kSubBuckets;
+constexpr size_t LatencyHistogram::kNumBuckets;
+
+namespace {
+
+// The index of the highest set bit. `value` must not be 0.
+inline uint64_t highBit(uint64_t value) {
+  uint64_t bit = 0;
+  while(value >>= 1) {
+    ++bit;
+  }
+  return bit;
+}
+
+}  // namespace
+
+size_t LatencyHistogram::bucketOf(uint64_t value) {
+  if(value < kSubBuckets) {
+    return value;
+  }
+
+  // The bits just below the highest set bit pick the bucket within the power
+  // of two.
+  const uint64_t shift = highBit(value) - kSubBits;
+  const uint64_t sub = (value >> shift) & (kSubBuckets - 1);
+
+  return (shift + 1) * kSubBuckets + sub;
+}
+
+// The largest value that is counted in the bucket.
+uint64_t LatencyHistogram::bucketLimit(size_t bucket) {
+  if(bucket < kSubBuckets) {
+    return bucket;
+  }
+
+  const uint64_t shift = bucket / kSubBuckets - 1;
+  const uint64_t sub = bucket % kSubBuckets;
+  const uint64_t lowest = (kSubBuckets + sub) << shift;
+
+  return lowest + ((uint64_t(1) << shift) - 1);
+}
+
+LatencyHistogram::LatencyHistogram() {
+  clear();
+}
+
+void LatencyHistogram::record(uint64_t value) {
+  ++buckets[bucketOf(value)];
+  ++count;
+  total += value;
+  maxValue = std::max(maxValue, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+  for(size_t i = 0; i < kNumBuckets; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+
+  count += other.count;
+  total += other.total;
+  maxValue = std::max(maxValue, other.maxValue);
+}
+
+void LatencyHistogram::clear() {
+  buckets.fill(0);
+  count = 0;
+  total = 0;
+  maxValue = 0;
+}
+
+uint64_t LatencyHistogram::getCount() const {
+  return count;
+}
+
+uint64_t LatencyHistogram::getTotal() const {
+  return total;
+}
+
+uint64_t LatencyHistogram::getMax() const {
+  return maxValue;
+}
+
+// Estimates the value that `fraction` of the samples are at or below, for
+// example 0.99 for the 99th percentile. The estimate never exceeds the
+// largest sample. Returns 0 if nothing has been recorded.
+uint64_t LatencyHistogram::percentile(double fraction) const {
+  if(count == 0) {
+    return 0;
+  }
+
+  const double clamped = std::min(std::max(fraction, 0.0), 1.0);
+  const double exactRank = std::ceil(clamped * static_cast<double>(count));
+  const uint64_t rank = std::max<uint64_t>(1, exactRank);
+
+  uint64_t seen = 0;
+  for(size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets[i];
+
+    if(seen >= rank) {
+      return std::min(bucketLimit(i), maxValue);
+    }
+  }
+
+  return maxValue;
+}
+
+}  // namespace Rally
@@ -0,0 +1,300 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "agent/agent-manager.h"
+#include "map/rally-map.h"
+
+using Rally::AgentManager;
+using Rally::AgentWrapper;
+using Rally::RallyMap;
+
+namespace {
+// Agents that should always find the cheapest path.
+const char* const kOptimalAgents[] = {
+    "Dijkstra",   "DijkstraOpt", "DijkstraDial",  "AStar",
+    "AStarOpt",   "NBAStar",     "NBAStarOpt",    "AStarOptALT",
+    "CH",         "DStarLite",   "NBAStarOptALT", "ARAStar"};
+
+bool isOptimal(const char* name) {
+  for(const auto& optimal : kOptimalAgents) {
+    if(std::strcmp(name, optimal) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// The agents the ALT agents are based on, each followed by its ALT version.
+const char* const kLandmarkPairs[][2] = {{"AStarOpt", "AStarOptALT"},
+                                         {"NBAStarOpt", "NBAStarOptALT"}};
+
+// The seed of the maps the landmark tests race on.
+const uint64_t kLandmarkSeed = 8;
+
+// The agent called `name`, or null if it isn't registered.
+AgentWrapper* findAgent(std::vector<AgentWrapper>& wrappers, const char* name) {
+  for(auto& agent : wrappers) {
+    if(std::strcmp(agent.getName(), name) == 0) {
+      return &agent;
+    }
+  }
+
+  return nullptr;
+}
+}  // namespace
+
+TEST(Agents, OptimalPathCost) {
+  std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  // Dijkstra's algorithm is the reference all the others are held to.
+  AgentWrapper* const reference = findAgent(wrappers, "Dijkstra");
+  ASSERT_NE(reference, nullptr);
+
+  for(uint race = 0; race < 200; ++race) {
+    RallyMap rally(2 + race % 23, 2 + race / 7 % 17);
+
+    for(auto& agent : wrappers) {
+      agent.addRace(rally);
+    }
+
+    ASSERT_TRUE(reference->finishedRace);
+
+    for(const auto& agent : wrappers) {
+      if(isOptimal(agent.getName())) {
+        EXPECT_TRUE(agent.finishedRace) << agent.getName() << "\n" << rally;
+        EXPECT_EQ(agent.pathCost, reference->pathCost)
+            << agent.getName() << "\n"
+            << rally;
+      }
+    }
+  }
+}
+
+// Agents keep scratch memory between races, which must not change the result
+// of any race.
+TEST(Agents, ReuseMatchesFresh) {
+  std::vector<AgentWrapper> reused;
+  AgentManager::GetInstance()->makeAgents(reused);
+
+  // Large maps are mixed in so state from a bigger race is left behind.
+  for(uint race = 0; race < 40; ++race) {
+    const uint size = race % 5 == 0 ? 40 : 2 + race % 13;
+    RallyMap rally(size, 2 + race % 11);
+
+    std::vector<AgentWrapper> fresh;
+    AgentManager::GetInstance()->makeAgents(fresh);
+
+    for(size_t i = 0; i < reused.size(); ++i) {
+      const Rally::RaceResult expected = fresh[i].runRace(rally);
+      const Rally::RaceResult result = reused[i].runRace(rally);
+
+      // Some agents are random, so only the deterministic ones are compared.
+      if(isOptimal(reused[i].getName())) {
+        EXPECT_EQ(result.path, expected.path) << reused[i].getName();
+        EXPECT_EQ(result.mapLooks, expected.mapLooks) << reused[i].getName();
+      }
+    }
+  }
+}
+
+// Agents that learn the whole map only pay for it once per terrain.
+TEST(Agents, HPAStarReusesTerrain) {
+  std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  AgentWrapper* const hpa = findAgent(wrappers, "HPAStar");
+  ASSERT_NE(hpa, nullptr);
+
+  Rally::Random random(5);
+  RallyMap rally(40, 30, random);
+
+  for(uint race = 0; race < 20; ++race) {
+    hpa->addRace(rally);
+
+    EXPECT_TRUE(hpa->finishedRace) << rally;
+    if(race == 0) {
+      EXPECT_EQ(hpa->mapLooks, 40 * 30);
+    } else {
+      EXPECT_LE(hpa->mapLooks, 2);
+    }
+
+    rally.randomizeEndPoints(random);
+  }
+}
+
+// Once the landmarks of a terrain are built, the tighter bound means the ALT
+// agents look at fewer hexes than the agents they're based on.
+TEST(Agents, LandmarksSaveLooks) {
+  std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  for(const auto& pair : kLandmarkPairs) {
+    AgentWrapper* const plain = findAgent(wrappers, pair[0]);
+    AgentWrapper* const alt = findAgent(wrappers, pair[1]);
+    ASSERT_NE(plain, nullptr);
+    ASSERT_NE(alt, nullptr);
+
+    Rally::Random random(kLandmarkSeed);
+    RallyMap rally(60, 50, random);
+
+    uint plainLooks = 0;
+    uint altLooks = 0;
+    for(uint race = 0; race < 20; ++race) {
+      plain->addRace(rally);
+      alt->addRace(rally);
+
+      if(race > 0) {
+        plainLooks += plain->mapLooks;
+        altLooks += alt->mapLooks;
+      }
+
+      rally.randomizeEndPoints(random);
+    }
+
+    EXPECT_LT(altLooks, plainLooks / 2) << pair[1];
+  }
+}
+
+// On a new terrain the ALT agents have to learn the whole map first, so when
+// every race is on its own terrain, as in `OffroadRally`, they look at the map
+// far more than the agents they're based on.
+TEST(Agents, LandmarksCostOnNewTerrain) {
+  std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  for(const auto& pair : kLandmarkPairs) {
+    AgentWrapper* const plain = findAgent(wrappers, pair[0]);
+    AgentWrapper* const alt = findAgent(wrappers, pair[1]);
+    ASSERT_NE(plain, nullptr);
+    ASSERT_NE(alt, nullptr);
+
+    Rally::Random random(kLandmarkSeed);
+
+    uint plainLooks = 0;
+    uint altLooks = 0;
+    for(uint race = 0; race < 20; ++race) {
+      const RallyMap rally(60, 50, random);
+      plain->addRace(rally);
+      alt->addRace(rally);
+
+      EXPECT_GE(alt->mapLooks, 60 * 50) << pair[1];
+      EXPECT_EQ(alt->pathCost, plain->pathCost) << pair[1];
+      plainLooks += plain->mapLooks;
+      altLooks += alt->mapLooks;
+    }
+
+    EXPECT_GT(altLooks, plainLooks * 2) << pair[1];
+  }
+}
+
+// An incremental agent racing to the same finish only learns the edited hexes
+// again, and still finds the cheapest path.
+TEST(Agents, DStarLiteFollowsEdits) {
+  std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  AgentWrapper* const dstar = findAgent(wrappers, "DStarLite");
+  AgentWrapper* const reference = findAgent(wrappers, "Dijkstra");
+  ASSERT_NE(dstar, nullptr);
+  ASSERT_NE(reference, nullptr);
+
+  Rally::Random random(6);
+  RallyMap rally(40, 30, random);
+
+  for(uint race = 0; race < 20; ++race) {
+    dstar->addRace(rally);
+    reference->addRace(rally);
+
+    EXPECT_TRUE(dstar->finishedRace) << rally;
+    EXPECT_EQ(dstar->pathCost, reference->pathCost) << rally;
+    if(race == 0) {
+      EXPECT_EQ(dstar->mapLooks, 40 * 30);
+    } else {
+      // One look for each edit and for the old start.
+      EXPECT_LE(dstar->mapLooks, 4);
+    }
+
+    for(uint edit = 0; edit < 3; ++edit) {
+      rally.setRoughness({static_cast<int>(random.below(40)),
+                          static_cast<int>(random.below(30))},
+                         0, random);
+    }
+
+    if(race % 2 == 0) {
+      Rally::Point start;
+      do {
+        start = {static_cast<int>(random.below(40)),
+                 static_cast<int>(random.below(30))};
+      } while(start == rally.getFinish());
+      rally.setEndPoints(start, rally.getFinish());
+    }
+  }
+}
+
+// Without a budget the anytime agent keeps going until it has the cheapest
+// path. With one it stops early, but still finishes within the bound it
+// reports.
+TEST(Agents, ARAStarBudget) {
+  std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  AgentWrapper* const ara = findAgent(wrappers, "ARAStar");
+  AgentWrapper* const reference = findAgent(wrappers, "Dijkstra");
+  ASSERT_NE(ara, nullptr);
+  ASSERT_NE(reference, nullptr);
+
+  Rally::Random random(9);
+  Rally::SearchBudget noBudget;
+  Rally::SearchBudget fewExpansions;
+  fewExpansions.maxExpansions = 1;
+  Rally::SearchBudget fewNanos;
+  fewNanos.maxNanos = 1;
+
+  for(uint race = 0; race < 20; ++race) {
+    const RallyMap rally(20 + race * 3, 15 + race * 2, random);
+    reference->addRace(rally);
+
+    ara->setBudget(noBudget);
+    ara->addRace(rally);
+    EXPECT_TRUE(ara->finishedRace) << rally;
+    EXPECT_EQ(ara->pathCost, reference->pathCost) << rally;
+    EXPECT_EQ(ara->bound, 1);
+
+    for(const auto& budget : {fewExpansions, fewNanos}) {
+      ara->setBudget(budget);
+      ara->addRace(rally);
+      EXPECT_TRUE(ara->finishedRace) << rally;
+      EXPECT_GE(ara->bound, 1);
+      EXPECT_LE(ara->bound, 3);
+      EXPECT_LE(ara->pathCost, ara->bound * reference->pathCost) << rally;
+    }
+  }
+}
+
+// Agents that search a graph of their own, rather than listing neighbors on
+// the map, still report the work they did.
+TEST(Agents, OwnGraphExpansions) {
+  std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  const char* const kOwnGraphAgents[] = {"CH", "HPAStar", "DStarLite"};
+
+  Rally::Random random(10);
+  RallyMap rally(40, 30, random);
+
+  for(const auto& name : kOwnGraphAgents) {
+    AgentWrapper* const agent = findAgent(wrappers, name);
+    ASSERT_NE(agent, nullptr);
+
+    // The second race only queries what the first one built.
+    for(uint race = 0; race < 2; ++race) {
+      const Rally::RaceResult result = agent->runRace(rally);
+      EXPECT_GT(result.expansions, 0) << name;
+      rally.randomizeEndPoints(random);
+    }
+  }
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "driver/map-corpus.h"
+#include "map/map-file.h"
+#include "map/rally-map.h"
+
+using Rally::Encoding;
+using Rally::Layout;
+using Rally::MapCorpus;
+using Rally::RallyMap;
+using Rally::Random;
+
+TEST(MapCorpus, Directory) {
+  const std::string dir = ::testing::TempDir() + "corpus-test";
+  ::mkdir(dir.c_str(), 0755);
+
+  Random random(5);
+  const RallyMap first(6, 4, random);
+  const RallyMap second(3, 7, random, Encoding::eNibble, Layout::ePadded);
+  const RallyMap third(5, 5, random);
+
+  // The files are raced in order of their names, and other files are skipped.
+  Rally::writeMapFile(dir + "/a.rallymap", first);
+  std::ofstream(dir + "/b.txt") << second.toString();
+  Rally::writeMapFile(dir + "/c.rallymap", third);
+  std::ofstream(dir + "/notes.md") << "not a map";
+
+  {
+    const MapCorpus corpus(dir, Encoding::eWide, Layout::eDense);
+    ASSERT_EQ(corpus.size(), 3);
+
+    EXPECT_EQ(corpus.load(0).toString(), first.toString());
+    EXPECT_EQ(corpus.load(2).toString(), third.toString());
+    EXPECT_TRUE(corpus.load(0).sharesCells());
+
+    // Text maps are converted to the corpus' encoding and layout.
+    const RallyMap text = corpus.load(1);
+    EXPECT_EQ(text.toString(), second.toString());
+    EXPECT_EQ(text.getEncoding(), Encoding::eWide);
+    EXPECT_EQ(text.getLayout(), Layout::eDense);
+  }
+
+  for(const auto& name : {"a.rallymap", "b.txt", "c.rallymap", "notes.md"}) {
+    std::remove((dir + "/" + name).c_str());
+  }
+
+  EXPECT_THROW(MapCorpus(dir, Encoding::eByte, Layout::eDense),
+               std::invalid_argument);
+  ::rmdir(dir.c_str());
+}
+
+TEST(MapCorpus, Archive) {
+  const std::string path = ::testing::TempDir() + "corpus-test.rallymap";
+
+  std::vector<RallyMap> maps;
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    for(uint i = 0; i < 4; ++i) {
+      Random random(i);
+      maps.push_back(RallyMap(4 + i, 4, random));
+      Rally::writeMapFile(out, maps.back());
+    }
+  }
+
+  const MapCorpus corpus(path, Encoding::eByte, Layout::eDense);
+  ASSERT_EQ(corpus.size(), maps.size());
+  for(size_t i = 0; i < maps.size(); ++i) {
+    EXPECT_EQ(corpus.load(i).toString(), maps[i].toString());
+  }
+
+  std::remove(path.c_str());
+  EXPECT_THROW(MapCorpus(path, Encoding::eByte, Layout::eDense),
+               std::runtime_error);
+}
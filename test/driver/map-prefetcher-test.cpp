@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "driver/map-prefetcher.h"
+#include "map/rally-map.h"
+
+using Rally::MapPrefetcher;
+using Rally::RallyMap;
+
+namespace {
+
+// Each map's width is its index plus two, so the order can be checked.
+RallyMap makeMap(size_t i) {
+  return RallyMap(i + 2, 2);
+}
+
+}  // namespace
+
+TEST(MapPrefetcher, InOrder) {
+  MapPrefetcher prefetcher(20, 3, makeMap);
+  std::vector<RallyMap> maps;
+
+  while(prefetcher.next(maps)) {
+  }
+
+  ASSERT_EQ(maps.size(), 20);
+  for(size_t i = 0; i < maps.size(); ++i) {
+    EXPECT_EQ(maps[i].getWidth(), i + 2);
+  }
+
+  EXPECT_FALSE(prefetcher.next(maps));
+}
+
+TEST(MapPrefetcher, Error) {
+  MapPrefetcher prefetcher(10, 2, [](size_t i) {
+    if(i == 4) {
+      throw std::runtime_error("bad map");
+    }
+    return makeMap(i);
+  });
+  std::vector<RallyMap> maps;
+
+  // The maps before the bad one are still handed out.
+  for(uint i = 0; i < 4; ++i) {
+    ASSERT_TRUE(prefetcher.next(maps));
+  }
+  EXPECT_THROW(prefetcher.next(maps), std::runtime_error);
+  EXPECT_EQ(maps.size(), 4);
+}
+
+TEST(MapPrefetcher, StopsEarly) {
+  // Destroying the prefetcher before every map is taken doesn't hang.
+  MapPrefetcher prefetcher(1000, 2, makeMap);
+  std::vector<RallyMap> maps;
+  EXPECT_TRUE(prefetcher.next(maps));
+}
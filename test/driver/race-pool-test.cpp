@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include "agent/agent-manager.h"
+#include "driver/race-pool.h"
+#include "map/rally-map.h"
+
+using Rally::AgentManager;
+using Rally::AgentWrapper;
+using Rally::RacePool;
+using Rally::RaceResult;
+using Rally::RallyMap;
+
+TEST(RacePool, MatchesSerial) {
+  std::vector<AgentWrapper> wrappers;
+  AgentManager::GetInstance()->makeAgents(wrappers);
+
+  RacePool pool(4);
+  ASSERT_EQ(pool.getNumThreads(), 4);
+
+  // Batches are run back to back to make sure the pool can be reused. Every
+  // batch gets new maps, so agents that remember terrains between races can't
+  // reuse one in the pool that the serial run doesn't.
+  for(uint batch = 0; batch < 3; ++batch) {
+    std::vector<RallyMap> maps;
+    for(uint race = 0; race < 40; ++race) {
+      maps.push_back(RallyMap(2 + race % 13, 2 + race / 3 % 11));
+    }
+
+    std::vector<std::vector<RaceResult>> results;
+    pool.runRaces(maps, results);
+
+    ASSERT_EQ(results.size(), maps.size());
+    for(size_t race = 0; race < maps.size(); ++race) {
+      ASSERT_EQ(results[race].size(), wrappers.size());
+
+      for(size_t agent = 0; agent < wrappers.size(); ++agent) {
+        const RaceResult expected = wrappers[agent].runRace(maps[race]);
+        const RaceResult& actual = results[race][agent];
+
+        EXPECT_EQ(actual.path, expected.path) << wrappers[agent].getName();
+        EXPECT_EQ(actual.mapLooks, expected.mapLooks)
+            << wrappers[agent].getName();
+        EXPECT_EQ(actual.pathCost, expected.pathCost);
+        EXPECT_EQ(actual.finishedRace, expected.finishedRace);
+      }
+    }
+  }
+}
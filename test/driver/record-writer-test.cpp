@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "driver/record-writer.h"
+#include "map/rally-map.h"
+
+using Rally::RaceResult;
+using Rally::RallyMap;
+using Rally::RecordFormat;
+using Rally::RecordWriter;
+
+namespace {
+
+RaceResult makeResult() {
+  RaceResult result;
+  result.path = {Direction::T::eNorth, Direction::T::eSouth};
+  result.mapLooks = 12;
+  result.expansions = 4;
+  result.pathCost = 7;
+  result.finishedRace = true;
+  result.wallNanos = 1500;
+  result.cpuNanos = 1400;
+  result.peakHeapBytes = 256;
+  result.allocations = 3;
+  result.allocatedBytes = 300;
+  result.bound = 1.5;
+  return result;
+}
+
+}  // namespace
+
+TEST(RecordWriter, Csv) {
+  const RallyMap map(5, 3);
+  std::ostringstream out;
+
+  {
+    RecordWriter writer(out, RecordFormat::eCsv);
+    writer.write(0, map, "AStar", makeResult());
+    writer.write(1, map, "Odd,\"Name\"", makeResult());
+  }
+
+  EXPECT_EQ(out.str(),
+            "race,width,height,agent,path_cost,finished,map_looks,expansions,"
+            "path_length,wall_ns,cpu_ns,peak_heap_bytes,allocations,"
+            "allocated_bytes,bound\n"
+            "0,5,3,AStar,7,true,12,4,2,1500,1400,256,3,300,1.5\n"
+            "1,5,3,\"Odd,\"\"Name\"\"\",7,true,12,4,2,1500,1400,256,3,300,"
+            "1.5\n");
+}
+
+TEST(RecordWriter, JsonLines) {
+  const RallyMap map(5, 3);
+  std::ostringstream out;
+
+  {
+    RecordWriter writer(out, RecordFormat::eJsonLines);
+    writer.write(2, map, "Say \"hi\"\n", makeResult());
+  }
+
+  EXPECT_EQ(out.str(),
+            "{\"race\":2,\"width\":5,\"height\":3,"
+            "\"agent\":\"Say \\\"hi\\\"\\u000a\",\"path_cost\":7,"
+            "\"finished\":true,\"map_looks\":12,\"expansions\":4,"
+            "\"path_length\":2,\"wall_ns\":1500,\"cpu_ns\":1400,"
+            "\"peak_heap_bytes\":256,\"allocations\":3,"
+            "\"allocated_bytes\":300,\"bound\":1.5}\n");
+}
+
+TEST(RecordWriter, Buffers) {
+  const RallyMap map(5, 3);
+  std::ostringstream out;
+  RecordWriter writer(out, RecordFormat::eJsonLines);
+
+  // A few records stay in the buffer until it's flushed.
+  writer.write(0, map, "AStar", makeResult());
+  EXPECT_TRUE(out.str().empty());
+
+  writer.flush();
+  EXPECT_FALSE(out.str().empty());
+
+  // Enough records are handed over without being asked to.
+  out.str("");
+  for(uint race = 0; race < 10000; ++race) {
+    writer.write(race, map, "AStar", makeResult());
+  }
+  EXPECT_FALSE(out.str().empty());
+}
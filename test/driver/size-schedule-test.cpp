@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include "driver/size-schedule.h"
+
+using Rally::parseSizeSchedule;
+
+TEST(SizeSchedule, Linear) {
+  std::vector<uint> sizes;
+
+  ASSERT_TRUE(parseSizeSchedule("linear:8:32:8", sizes));
+  EXPECT_EQ(sizes, std::vector<uint>({8, 16, 24, 32}));
+
+  // The max is included even when the steps skip over it.
+  ASSERT_TRUE(parseSizeSchedule("linear:8:30:8", sizes));
+  EXPECT_EQ(sizes, std::vector<uint>({8, 16, 24, 30}));
+
+  ASSERT_TRUE(parseSizeSchedule("linear:5:5:1", sizes));
+  EXPECT_EQ(sizes, std::vector<uint>({5}));
+}
+
+TEST(SizeSchedule, Geometric) {
+  std::vector<uint> sizes;
+
+  ASSERT_TRUE(parseSizeSchedule("geometric:8:16384:2", sizes));
+  ASSERT_EQ(sizes.size(), 12);
+  EXPECT_EQ(sizes.front(), 8);
+  EXPECT_EQ(sizes[1], 16);
+  EXPECT_EQ(sizes.back(), 16384);
+
+  ASSERT_TRUE(parseSizeSchedule("geometric:10:40:1.5", sizes));
+  EXPECT_EQ(sizes, std::vector<uint>({10, 15, 23, 35, 40}));
+
+  // A ratio close to one still makes progress.
+  ASSERT_TRUE(parseSizeSchedule("geometric:2:5:1.01", sizes));
+  EXPECT_EQ(sizes, std::vector<uint>({2, 3, 4, 5}));
+}
+
+TEST(SizeSchedule, List) {
+  std::vector<uint> sizes;
+
+  ASSERT_TRUE(parseSizeSchedule("list:512,8,64,8", sizes));
+  EXPECT_EQ(sizes, std::vector<uint>({8, 64, 512}));
+
+  ASSERT_TRUE(parseSizeSchedule("list:16384", sizes));
+  EXPECT_EQ(sizes, std::vector<uint>({16384}));
+}
+
+TEST(SizeSchedule, Invalid) {
+  std::vector<uint> sizes = {7};
+
+  for(const auto& schedule :
+      {"", "8", "list", "list:", "list:8,", "list:8,,16", "list:-8", "list:1",
+       "list:16385", "list:8x", "linear:8:32", "linear:32:8:1", "linear:8:32:0",
+       "linear:8:32:-1", "geometric:8:32:1", "geometric:8:32:0.5",
+       "geometric:8:32:2x", "geometric:8:32:inf", "cubic:8:32:2"}) {
+    EXPECT_FALSE(parseSizeSchedule(schedule, sizes)) << schedule;
+  }
+
+  // The sizes are left alone when parsing fails.
+  EXPECT_EQ(sizes, std::vector<uint>({7}));
+}
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "map/map-file.h"
+#include "map/rally-map.h"
+
+using Rally::Encoding;
+using Rally::Layout;
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+
+namespace {
+
+// A file in the test's temporary directory that's removed afterwards.
+class TempFile {
+  std::string path;
+
+ public:
+  explicit TempFile(const std::string& name)
+      : path(::testing::TempDir() + name) {}
+  ~TempFile() { std::remove(path.c_str()); }
+
+  const std::string& getPath() const { return path; }
+
+  std::string read() const {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream out;
+    out << in.rdbuf();
+    return out.str();
+  }
+
+  void write(const std::string& bytes) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << bytes;
+  }
+};
+
+}  // namespace
+
+TEST(MapFile, RoundTrip) {
+  for(const auto& encoding :
+      {Encoding::eWide, Encoding::eByte, Encoding::eNibble}) {
+    for(const auto& layout : {Layout::eDense, Layout::ePadded}) {
+      Random random(7);
+      const RallyMap map(13, 6, random, encoding, layout);
+      TempFile file("round-trip.rallymap");
+
+      Rally::writeMapFile(file.getPath(), map);
+      const RallyMap loaded = Rally::loadMapFile(file.getPath());
+
+      EXPECT_TRUE(loaded.sharesCells());
+      EXPECT_EQ(loaded.getWidth(), map.getWidth());
+      EXPECT_EQ(loaded.getHeight(), map.getHeight());
+      EXPECT_EQ(loaded.getStart(), map.getStart());
+      EXPECT_EQ(loaded.getFinish(), map.getFinish());
+      EXPECT_EQ(loaded.getLayout(), layout);
+      EXPECT_EQ(loaded.getAllRoughness(), map.getAllRoughness());
+      EXPECT_EQ(loaded.toString(), map.toString());
+
+      // Wide maps are stored as bytes.
+      EXPECT_EQ(loaded.getEncoding(),
+                encoding == Encoding::eWide ? Encoding::eByte : encoding);
+    }
+  }
+}
+
+TEST(MapFile, SharedUntilChanged) {
+  Random random(11);
+  const RallyMap map(9, 9, random);
+  TempFile file("shared.rallymap");
+  Rally::writeMapFile(file.getPath(), map);
+
+  RallyMap loaded = Rally::loadMapFile(file.getPath());
+  const RallyMap copy(loaded);
+  EXPECT_TRUE(copy.sharesCells());
+  EXPECT_EQ(copy.getCellData(), loaded.getCellData());
+
+  // Changing the map copies its cells, and leaves the file and the other
+  // copies alone.
+  const Point pos = {3, 4};
+  const uint before = loaded.getRoughness(pos);
+  loaded.setRoughness(pos, before == 1 ? 2 : 1);
+
+  EXPECT_FALSE(loaded.sharesCells());
+  EXPECT_NE(loaded.getRoughness(pos), before);
+  EXPECT_EQ(copy.getRoughness(pos), before);
+  EXPECT_EQ(Rally::loadMapFile(file.getPath()).getRoughness(pos), before);
+}
+
+TEST(MapFile, Invalid) {
+  Random random(3);
+  const RallyMap map(6, 5, random, Encoding::eByte, Layout::ePadded);
+  std::ostringstream out;
+  Rally::writeMapFile(out, map);
+  const std::string good = out.str();
+
+  TempFile file("invalid.rallymap");
+  EXPECT_THROW(Rally::loadMapFile(file.getPath()), std::runtime_error);
+
+  const auto expectInvalid = [&](const std::string& bytes) {
+    file.write(bytes);
+    EXPECT_THROW(Rally::loadMapFile(file.getPath()), std::exception);
+  };
+
+  expectInvalid("");
+  expectInvalid(good.substr(0, Rally::kMapFileHeaderSize - 1));
+  expectInvalid(good.substr(0, good.size() - 1));
+
+  std::string bad = good;
+  bad[0] = 'X';
+  expectInvalid(bad);
+
+  bad = good;
+  bad[8] = 2;  // version
+  expectInvalid(bad);
+
+  bad = good;
+  bad[12] = static_cast<char>(Encoding::eWide);
+  expectInvalid(bad);
+
+  bad = good;
+  bad[13] = 7;  // layout
+  expectInvalid(bad);
+
+  bad = good;
+  bad[24] = bad[32];  // start on top of the finish
+  bad[28] = bad[36];
+  expectInvalid(bad);
+
+  // A roughness out of range, and a sentinel that isn't zero.
+  const size_t firstHex = Rally::kMapFileHeaderSize + map.getStride() + 1;
+  bad = good;
+  bad[firstHex] = 10;
+  expectInvalid(bad);
+
+  bad = good;
+  bad[firstHex - 1] = 1;
+  expectInvalid(bad);
+
+  file.write(good);
+  EXPECT_NO_THROW(Rally::loadMapFile(file.getPath()));
+}
+
+TEST(MapFile, Archive) {
+  std::vector<RallyMap> maps;
+  std::ostringstream out;
+
+  for(uint i = 0; i < 5; ++i) {
+    Random random(i);
+    maps.push_back(RallyMap(4 + i, 9 - i, random,
+                            i % 2 ? Encoding::eNibble : Encoding::eByte,
+                            i % 3 ? Layout::eDense : Layout::ePadded));
+    Rally::writeMapFile(out, maps.back());
+  }
+
+  TempFile file("archive.rallymap");
+  file.write(out.str());
+
+  std::unique_ptr<Rally::MapArchive> archive(
+      new Rally::MapArchive(file.getPath()));
+  ASSERT_EQ(archive->size(), maps.size());
+
+  // Maps are loaded in any order, and outlive the archive they came from.
+  std::vector<RallyMap> loaded;
+  for(size_t i = maps.size(); i-- > 0;) {
+    loaded.push_back(archive->load(i));
+  }
+  EXPECT_THROW(archive->load(maps.size()), std::out_of_range);
+  archive.reset();
+
+  for(size_t i = 0; i < maps.size(); ++i) {
+    const RallyMap& map = loaded[maps.size() - 1 - i];
+    EXPECT_EQ(map.toString(), maps[i].toString());
+    EXPECT_EQ(map.getEncoding(), maps[i].getEncoding());
+    EXPECT_EQ(map.getLayout(), maps[i].getLayout());
+  }
+
+  // A single map file has to hold exactly one map.
+  EXPECT_THROW(Rally::loadMapFile(file.getPath()), std::invalid_argument);
+}
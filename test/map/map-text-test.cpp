@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+
+#include "map/map-text.h"
+#include "map/rally-map.h"
+
+using Rally::Encoding;
+using Rally::Layout;
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+
+namespace {
+
+RallyMap parse(const std::string& text,
+               Encoding encoding = Rally::kDefaultEncoding,
+               Layout layout = Rally::kDefaultLayout) {
+  std::istringstream in(text);
+  return Rally::parseMapText(in, encoding, layout);
+}
+
+const std::vector<std::vector<uint>> kReadmeRoughness{
+    {8, 1, 3, 5}, {1, 4, 5, 6}, {3, 8, 9, 4}, {1, 5, 9, 1}};
+
+}  // namespace
+
+TEST(MapText, Readme) {
+  const RallyMap map = parse(
+      " |\n"
+      "8 1 3 5\n"
+      " * 4 5 6\n"
+      "  3 8 9 4\n"
+      "   1 5 9 &\n"
+      "         |\n");
+
+  EXPECT_EQ(map.getWidth(), 4);
+  EXPECT_EQ(map.getHeight(), 4);
+  EXPECT_EQ(map.getStart(), Point({0, 1}));
+  EXPECT_EQ(map.getFinish(), Point({3, 3}));
+  EXPECT_EQ(map.getAllRoughness(), kReadmeRoughness);
+}
+
+TEST(MapText, Compact) {
+  const RallyMap map = parse("8135\r\n*456\r\n3894\r\n159&\r\n\r\n");
+
+  EXPECT_EQ(map.getStart(), Point({0, 1}));
+  EXPECT_EQ(map.getFinish(), Point({3, 3}));
+  EXPECT_EQ(map.getAllRoughness(), kReadmeRoughness);
+
+  // The markers are optional in the rhombus format too.
+  EXPECT_EQ(parse("8 1 3 5\n * 4 5 6\n  3 8 9 4\n   1 5 9 &\n").toString(),
+            map.toString());
+}
+
+TEST(MapText, RoundTrip) {
+  for(const auto& layout : {Layout::eDense, Layout::ePadded}) {
+    Random random(21);
+    const RallyMap map(17, 9, random);
+    const RallyMap parsed = parse(map.toString(), Encoding::eNibble, layout);
+
+    EXPECT_EQ(parsed.getEncoding(), Encoding::eNibble);
+    EXPECT_EQ(parsed.getLayout(), layout);
+    EXPECT_EQ(parsed.toString(), map.toString());
+    EXPECT_EQ(parsed.getStart(), map.getStart());
+    EXPECT_EQ(parsed.getFinish(), map.getFinish());
+  }
+}
+
+TEST(MapText, Invalid) {
+  for(const auto& text : {
+          "",
+          "\n\n",
+          "12\n",            // too small
+          "1*\n&1\n1",       // too small, and not square
+          "1*3\n&1\n",       // jagged
+          "1*\n11\n",        // no finish
+          "**\n&1\n",        // two starts
+          "1*\n&0\n",        // roughness out of range
+          "1*\n&x\n",        // not a hex
+          "1 *\n& 1\n",      // rhombus row without its leading space
+          "1  *\n & 1\n",    // double space
+          "1 *\n & 1\n\n11\n",  // text after the end
+          "|\n1 *\n & 1\n",  // start marker in the wrong column
+          "1 *\n & 1\n  |\n",  // finish marker in the wrong column
+          "  |\n  |\n1 *\n & 1\n",
+      }) {
+    EXPECT_THROW(parse(text), std::invalid_argument) << text;
+  }
+
+  EXPECT_THROW(Rally::loadMapText("/nonexistent/map.txt"), std::runtime_error);
+}
@@ -26,6 +26,16 @@ std::vector<std::vector<uint>> kLargeValueTemplate{
     {9000, 9000, 9000, 9000, 9000},
     {9000, 9000, 9000, 9000, 9000}};
 
+// Copies the neighbors of a point into a sorted vector so they can be compared.
+std::vector<std::pair<Point, Direction::T>> sortedNeighbors(const RallyMap& map,
+                                                            Point pos) {
+  const Rally::NeighborList neighbors = map.getNeighbors(pos);
+  std::vector<std::pair<Point, Direction::T>> sorted(neighbors.begin(),
+                                                     neighbors.end());
+  std::sort(sorted.begin(), sorted.end());
+  return sorted;
+}
+
 std::vector<Direction::T> kDiagonalPath{
     Direction::T::eNorthEast, Direction::T::eSouthEast,
     Direction::T::eNorthEast, Direction::T::eSouthEast,
@@ -281,6 +291,48 @@ TEST(RallyMap, Randomization) {
   EXPECT_TRUE(differentStart && differentFinish);
 }
 
+TEST(RallyMap, Edits) {
+  RallyMap map(9, 9);
+  const uint64_t before = map.getTerrainId();
+  std::vector<Point> edited;
+
+  EXPECT_TRUE(map.getEditsSince(before, edited));
+  EXPECT_TRUE(edited.empty());
+
+  map.setRoughness({1, 2}, 3);
+  const uint64_t middle = map.getTerrainId();
+  map.setRoughness({4, 5}, 6);
+  map.setRoughness({1, 2}, 7);
+  EXPECT_NE(map.getTerrainId(), before);
+
+  EXPECT_TRUE(map.getEditsSince(before, edited));
+  EXPECT_EQ(edited, std::vector<Point>({{1, 2}, {4, 5}, {1, 2}}));
+
+  edited.clear();
+  EXPECT_TRUE(map.getEditsSince(middle, edited));
+  EXPECT_EQ(edited, std::vector<Point>({{4, 5}, {1, 2}}));
+
+  // Copies share the edits along with the terrain id.
+  RallyMap copy(map);
+  edited.clear();
+  EXPECT_TRUE(copy.getEditsSince(middle, edited));
+  EXPECT_EQ(edited.size(), 2);
+
+  // Only the latest edits are kept.
+  for(size_t i = 0; i < RallyMap::kMaxEdits; ++i) {
+    map.setRoughness({0, 0}, 1 + i % 9);
+  }
+  edited.clear();
+  EXPECT_FALSE(map.getEditsSince(before, edited));
+  EXPECT_TRUE(edited.empty());
+
+  // Setting the roughness as a whole forgets the edits.
+  const uint64_t last = map.getTerrainId();
+  map.randomizeRoughness();
+  EXPECT_FALSE(map.getEditsSince(last, edited));
+  EXPECT_FALSE(copy.getEditsSince(last, edited));
+}
+
 TEST(RallyMap, Destination) {
   Point topLeft{0, 0};
   Point top{2, 0};
@@ -386,37 +438,32 @@ TEST(RallyMap, Neighbors) {
 
   using namespace Direction;
 
-  auto neighbor = testRally.getNeighbors(topLeft);
-  std::sort(neighbor.begin(), neighbor.end());
+  auto neighbor = sortedNeighbors(testRally, topLeft);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{0, 1}), T::eSouthEast),
                           std::make_pair((Point{1, 0}), T::eNorthEast)}));
 
-  neighbor = testRally.getNeighbors(top);
-  std::sort(neighbor.begin(), neighbor.end());
+  neighbor = sortedNeighbors(testRally, top);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{1, 0}), T::eSouthWest),
                           std::make_pair((Point{1, 1}), T::eSouth),
                           std::make_pair((Point{2, 1}), T::eSouthEast),
                           std::make_pair((Point{3, 0}), T::eNorthEast)}));
 
-  neighbor = testRally.getNeighbors(topRight);
-  std::sort(neighbor.begin(), neighbor.end());
+  neighbor = sortedNeighbors(testRally, topRight);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{3, 0}), T::eSouthWest),
                           std::make_pair((Point{3, 1}), T::eSouth),
                           std::make_pair((Point{4, 1}), T::eSouthEast)}));
 
-  neighbor = testRally.getNeighbors(left);
-  std::sort(neighbor.begin(), neighbor.end());
+  neighbor = sortedNeighbors(testRally, left);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{0, 1}), T::eNorthWest),
                           std::make_pair((Point{0, 3}), T::eSouthEast),
                           std::make_pair((Point{1, 1}), T::eNorth),
                           std::make_pair((Point{1, 2}), T::eNorthEast)}));
 
-  neighbor = testRally.getNeighbors(middle);
-  std::sort(neighbor.begin(), neighbor.end());
+  neighbor = sortedNeighbors(testRally, middle);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{1, 2}), T::eSouthWest),
                           std::make_pair((Point{1, 3}), T::eSouth),
@@ -425,36 +472,55 @@ TEST(RallyMap, Neighbors) {
                           std::make_pair((Point{3, 1}), T::eNorth),
                           std::make_pair((Point{3, 2}), T::eNorthEast)}));
 
-  neighbor = testRally.getNeighbors(right);
-  std::sort(neighbor.begin(), neighbor.end());
+  neighbor = sortedNeighbors(testRally, right);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{3, 2}), T::eSouthWest),
                           std::make_pair((Point{3, 3}), T::eSouth),
                           std::make_pair((Point{4, 1}), T::eNorthWest),
                           std::make_pair((Point{4, 3}), T::eSouthEast)}));
 
-  neighbor = testRally.getNeighbors(bottomLeft);
-  std::sort(neighbor.begin(), neighbor.end());
+  neighbor = sortedNeighbors(testRally, bottomLeft);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{0, 3}), T::eNorthWest),
                           std::make_pair((Point{1, 3}), T::eNorth),
                           std::make_pair((Point{1, 4}), T::eNorthEast)}));
 
-  neighbor = testRally.getNeighbors(bottom);
-  std::sort(neighbor.begin(), neighbor.end());
+  neighbor = sortedNeighbors(testRally, bottom);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{1, 4}), T::eSouthWest),
                           std::make_pair((Point{2, 3}), T::eNorthWest),
                           std::make_pair((Point{3, 3}), T::eNorth),
                           std::make_pair((Point{3, 4}), T::eNorthEast)}));
 
-  neighbor = testRally.getNeighbors(bottomRight);
-  std::sort(neighbor.begin(), neighbor.end());
+  neighbor = sortedNeighbors(testRally, bottomRight);
   EXPECT_EQ(neighbor, (std::vector<std::pair<Point, T>>{
                           std::make_pair((Point{3, 4}), T::eSouthWest),
                           std::make_pair((Point{4, 3}), T::eNorthWest)}));
 }
 
+TEST(RallyMap, RelevantNeighbors) {
+  RallyMap testRally({0, 0}, {4, 4}, kRandomSquareemplate);
+
+  using namespace Direction;
+
+  // With no parent direction every neighbor is relevant.
+  EXPECT_EQ(testRally.getRelevantNeighbors({2, 2}, T::eNone),
+            testRally.getNeighbors({2, 2}));
+
+  // Only the moves that continue forwards are relevant.
+  auto neighbor = testRally.getRelevantNeighbors({2, 2}, T::eNorth);
+  ASSERT_EQ(neighbor.size(), 3);
+  EXPECT_EQ(neighbor[0], std::make_pair((Point{2, 1}), T::eNorthWest));
+  EXPECT_EQ(neighbor[1], std::make_pair((Point{3, 1}), T::eNorth));
+  EXPECT_EQ(neighbor[2], std::make_pair((Point{3, 2}), T::eNorthEast));
+  EXPECT_ANY_THROW(neighbor.at(3));
+
+  // Moves off the map are left out.
+  neighbor = testRally.getRelevantNeighbors({4, 2}, T::eNorthEast);
+  ASSERT_EQ(neighbor.size(), 1);
+  EXPECT_EQ(neighbor[0], std::make_pair((Point{4, 3}), T::eSouthEast));
+}
+
 TEST(RallyMap, MoveCost) {
   RallyMap costTest(
       {3, 0}, {3, 2},
@@ -669,3 +735,87 @@ TEST(RallyMap, ToString) {
              "    1 1 8 1 1 1 8 8 8 8 8 1 8 8 8 8 8 1 1 1 8 1 1\n"
              "   |\n"));
 }
+
+TEST(RallyMap, Encoding) {
+  using namespace Direction;
+
+  RallyMap wide({0, 0}, {22, 4}, kTestTemplate, Rally::Encoding::eWide);
+  RallyMap byte({0, 0}, {22, 4}, kTestTemplate, Rally::Encoding::eByte);
+  RallyMap nibble({0, 0}, {22, 4}, kTestTemplate, Rally::Encoding::eNibble);
+
+  // Every encoding behaves the same.
+  EXPECT_EQ(wide.getAllRoughness(), kTestTemplate);
+  EXPECT_EQ(byte.getAllRoughness(), kTestTemplate);
+  EXPECT_EQ(nibble.getAllRoughness(), kTestTemplate);
+
+  EXPECT_EQ(wide.toString(), byte.toString());
+  EXPECT_EQ(wide.toString(), nibble.toString());
+
+  EXPECT_EQ(wide.analyzePath(kShorterPath), byte.analyzePath(kShorterPath));
+  EXPECT_EQ(wide.analyzePath(kShorterPath), nibble.analyzePath(kShorterPath));
+  EXPECT_EQ(wide.analyzePath(kSpiralPath), nibble.analyzePath(kSpiralPath));
+
+  // Setting a hex doesn't disturb the hex sharing its byte.
+  nibble.setRoughness({3, 1}, 7);
+  EXPECT_EQ(nibble.getRoughness({3, 1}), 7);
+  EXPECT_EQ(nibble.getRoughness({2, 1}), 8);
+  EXPECT_EQ(nibble.getRoughness({4, 1}), 1);
+
+  // Converting between encodings keeps the roughness.
+  wide.setRoughness({3, 1}, 7);
+  wide.setEncoding(Rally::Encoding::eNibble);
+  EXPECT_EQ(wide.getEncoding(), Rally::Encoding::eNibble);
+  EXPECT_EQ(wide.getAllRoughness(), nibble.getAllRoughness());
+
+  // Odd sized maps still round up to a whole byte.
+  EXPECT_EQ(RallyMap::memoryFootprint(Rally::Encoding::eWide, 3, 3),
+            9 * sizeof(uint));
+  EXPECT_EQ(RallyMap::memoryFootprint(Rally::Encoding::eByte, 3, 3), 9);
+  EXPECT_EQ(RallyMap::memoryFootprint(Rally::Encoding::eNibble, 3, 3), 5);
+  EXPECT_EQ(byte.getMemoryFootprint(),
+            RallyMap::memoryFootprint(Rally::Encoding::eByte, 23, 5));
+  EXPECT_EQ(wide.getMemoryFootprint(),
+            RallyMap::memoryFootprint(Rally::Encoding::eNibble, 23, 5));
+}
+
+TEST(RallyMap, Layout) {
+  RallyMap dense({3, 0}, {3, 2},
+                 std::vector<std::vector<uint>>{
+                     {1, 2, 3, 7}, {4, 5, 6, 8}, {7, 8, 9, 9}},
+                 Rally::Encoding::eByte, Rally::Layout::eDense);
+
+  for(const auto& encoding : {Rally::Encoding::eWide, Rally::Encoding::eByte,
+                              Rally::Encoding::eNibble}) {
+    RallyMap padded(dense);
+    padded.setEncoding(encoding);
+    padded.setLayout(Rally::Layout::ePadded);
+
+    EXPECT_EQ(padded.getLayout(), Rally::Layout::ePadded);
+    EXPECT_EQ(padded.getStride(), dense.getWidth() + 2);
+    EXPECT_EQ(padded.getAllRoughness(), dense.getAllRoughness());
+    EXPECT_EQ(padded.toString(), dense.toString());
+    EXPECT_EQ(padded.getMemoryFootprint(),
+              RallyMap::memoryFootprint(encoding, 4, 3,
+                                        Rally::Layout::ePadded));
+
+    // Moving into the sentinels bounces back exactly like the bounds checks.
+    for(int y = 0; y < 3; ++y) {
+      for(int x = 0; x < 4; ++x) {
+        for(const auto& dir : Direction::kAllMoveDirections) {
+          EXPECT_EQ(padded.getDestination({x, y}, dir),
+                    dense.getDestination({x, y}, dir));
+          EXPECT_EQ(padded.getMoveCost({x, y}, dir),
+                    dense.getMoveCost({x, y}, dir));
+        }
+
+        EXPECT_EQ(padded.getNeighbors({x, y}), dense.getNeighbors({x, y}));
+        EXPECT_EQ(padded.getDestination({x, y}, Direction::T::eNone),
+                  (Point{x, y}));
+      }
+    }
+
+    // Converting back keeps the roughness.
+    padded.setLayout(Rally::Layout::eDense);
+    EXPECT_EQ(padded.getAllRoughness(), dense.getAllRoughness());
+  }
+}
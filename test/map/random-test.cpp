@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "map/random.h"
+#include "map/rally-map.h"
+
+using Rally::RallyMap;
+using Rally::Random;
+
+TEST(Random, Deterministic) {
+  Random a(42);
+  Random b(42);
+  Random c(43);
+
+  bool differs = false;
+  for(uint i = 0; i < 100; ++i) {
+    const uint64_t value = a.next();
+    EXPECT_EQ(value, b.next());
+    differs = differs || value != c.next();
+  }
+  EXPECT_TRUE(differs);
+
+  // Each stream gets its own seed.
+  EXPECT_EQ(Random::deriveSeed(42, 7), Random::deriveSeed(42, 7));
+  EXPECT_NE(Random::deriveSeed(42, 7), Random::deriveSeed(42, 8));
+  EXPECT_NE(Random::deriveSeed(42, 7), Random::deriveSeed(43, 7));
+}
+
+TEST(Random, Range) {
+  Random random(1);
+  uint counts[9] = {};
+
+  for(uint i = 0; i < 9000; ++i) {
+    const uint value = random.below(9);
+    ASSERT_LT(value, 9);
+    ++counts[value];
+  }
+
+  // Every value should come up, and none should be wildly overrepresented.
+  for(const auto& count : counts) {
+    EXPECT_GT(count, 800);
+    EXPECT_LT(count, 1200);
+  }
+
+  // Odd counts still fill every value.
+  std::vector<uint> values(7, 0);
+  random.fillRange(values.size(), 9,
+                   [&](uint64_t i, uint value) { values[i] = value; });
+  for(const auto& value : values) {
+    EXPECT_GE(value, 1);
+    EXPECT_LE(value, 9);
+  }
+}
+
+TEST(Random, SeededMaps) {
+  Random a(Random::deriveSeed(5, 3));
+  Random b(Random::deriveSeed(5, 3));
+
+  const RallyMap first(17, 11, a);
+  const RallyMap second(17, 11, b);
+
+  EXPECT_EQ(first.getAllRoughness(), second.getAllRoughness());
+  EXPECT_EQ(first.getStart(), second.getStart());
+  EXPECT_EQ(first.getFinish(), second.getFinish());
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "search/arena.h"
+#include "search/two-level-bucket-queue.h"
+
+using Rally::Arena;
+using Rally::ArenaAllocator;
+using Rally::ArenaPriorityQueue;
+using Rally::ArenaSet;
+using Rally::ArenaUnorderedMap;
+using Rally::ArenaVector;
+
+TEST(Arena, Alignment) {
+  Arena arena;
+
+  for(size_t alignment : {1, 2, 8, 64, 1}) {
+    void* ptr = arena.allocate(3, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+  }
+
+  // Larger than any block so far.
+  void* big = arena.allocate(1 << 20, 16);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % 16, 0);
+  EXPECT_EQ(arena.getNumBlocks(), 2);
+}
+
+TEST(Arena, Release) {
+  Arena arena;
+
+  for(int i = 0; i < 100; ++i) {
+    arena.allocate(10000, 8);
+  }
+
+  const size_t capacity = arena.capacity();
+  EXPECT_GT(arena.getNumBlocks(), 1);
+
+  // The blocks are merged, so the same allocations fit in one block next time.
+  arena.release();
+  EXPECT_EQ(arena.getNumBlocks(), 1);
+  EXPECT_EQ(arena.capacity(), capacity);
+
+  void* first = arena.allocate(10000, 8);
+  for(int i = 1; i < 100; ++i) {
+    arena.allocate(10000, 8);
+  }
+
+  EXPECT_EQ(arena.getNumBlocks(), 1);
+
+  arena.release();
+  EXPECT_EQ(arena.allocate(10000, 8), first);
+}
+
+TEST(Arena, Containers) {
+  Arena arena;
+
+  ArenaVector<int> vector(arena);
+  ArenaSet<int> set(arena);
+  ArenaUnorderedMap<int, int> map(arena);
+  ArenaPriorityQueue<int> queue(arena);
+
+  for(int i = 0; i < 1000; ++i) {
+    vector.push_back(i);
+    set.insert(999 - i);
+    map[i] = i * 2;
+    queue.push(999 - i);
+  }
+
+  EXPECT_EQ(vector[500], 500);
+  EXPECT_EQ(*set.begin(), 0);
+  EXPECT_EQ(map.at(500), 1000);
+  EXPECT_EQ(queue.top(), 0);
+  EXPECT_EQ(vector.get_allocator(), ArenaAllocator<int>(arena));
+
+  Rally::TwoLevelBucketQueue<int, ArenaAllocator<int>> buckets(4, arena);
+  buckets.push(3, 1, 31);
+  buckets.push(3, 0, 30);
+  buckets.push(5, 0, 50);
+  EXPECT_EQ(buckets.top(), 30);
+  buckets.pop();
+  EXPECT_EQ(buckets.top(), 31);
+}
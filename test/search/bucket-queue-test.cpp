@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include "search/bucket-queue.h"
+#include "search/two-level-bucket-queue.h"
+
+using Rally::BucketQueue;
+using Rally::TwoLevelBucketQueue;
+
+TEST(BucketQueue, Order) {
+  BucketQueue<int> queue(4);
+
+  EXPECT_TRUE(queue.empty());
+
+  queue.push(3, 30);
+  queue.push(7, 70);
+  queue.push(5, 50);
+  queue.push(3, 31);
+
+  EXPECT_EQ(queue.size(), 4);
+  EXPECT_EQ(queue.topKey(), 3);
+  EXPECT_EQ(queue.top(), 31);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 30);
+  queue.pop();
+
+  // Keys wrap around the buckets as the smallest key grows.
+  EXPECT_EQ(queue.topKey(), 5);
+  queue.push(9, 90);
+  queue.push(6, 60);
+  EXPECT_EQ(queue.top(), 50);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 60);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 70);
+  queue.pop();
+  EXPECT_EQ(queue.topKey(), 9);
+  EXPECT_EQ(queue.top(), 90);
+  queue.pop();
+
+  EXPECT_TRUE(queue.empty());
+
+  // An empty queue can restart at any key.
+  queue.push(1000, 1);
+  EXPECT_EQ(queue.topKey(), 1000);
+}
+
+TEST(BucketQueue, Range) {
+  BucketQueue<int> queue(4);
+
+  queue.push(10, 0);
+  EXPECT_NO_THROW(queue.push(14, 0));
+  EXPECT_ANY_THROW(queue.push(15, 0));
+  EXPECT_ANY_THROW(queue.push(9, 0));
+
+  queue.clear();
+  EXPECT_TRUE(queue.empty());
+  EXPECT_NO_THROW(queue.push(2, 0));
+}
+
+TEST(BucketQueue, PushAfterEmptied) {
+  BucketQueue<int> queue(18);
+
+  // Emptying the queue doesn't fix the smallest key to the next key pushed.
+  queue.push(0, 0);
+  queue.pop();
+  queue.push(5, 5);
+  EXPECT_NO_THROW(queue.push(3, 3));
+  EXPECT_EQ(queue.top(), 3);
+}
+
+TEST(TwoLevelBucketQueue, Order) {
+  TwoLevelBucketQueue<int> queue(8);
+
+  // Secondary keys can be pushed in any order, including below every key
+  // already in the bucket.
+  queue.push(10, 500, 1);
+  queue.push(10, 2, 2);
+  queue.push(12, 0, 3);
+  queue.push(10, 7, 4);
+  queue.push(10, 1000, 5);
+  queue.push(10, 2, 6);
+
+  EXPECT_EQ(queue.size(), 6);
+  EXPECT_EQ(queue.topKey(), 10);
+  EXPECT_EQ(queue.top(), 6);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 2);
+  queue.pop();
+
+  queue.push(10, 0, 7);
+  EXPECT_EQ(queue.top(), 7);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 4);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 1);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 5);
+  queue.pop();
+
+  // Primary keys wrap around the buckets as the smallest key grows.
+  EXPECT_EQ(queue.topKey(), 12);
+  queue.push(20, 3, 8);
+  queue.push(20, 1, 9);
+  EXPECT_EQ(queue.top(), 3);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 9);
+  queue.pop();
+  EXPECT_EQ(queue.top(), 8);
+  queue.pop();
+
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(TwoLevelBucketQueue, Range) {
+  TwoLevelBucketQueue<int> queue(4);
+
+  queue.push(10, 0, 0);
+  EXPECT_NO_THROW(queue.push(14, 0, 0));
+  EXPECT_ANY_THROW(queue.push(15, 0, 0));
+  EXPECT_ANY_THROW(queue.push(9, 0, 0));
+
+  queue.clear();
+  EXPECT_TRUE(queue.empty());
+  EXPECT_NO_THROW(queue.push(2, 0, 0));
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "map/map-interface.h"
+#include "search/arena.h"
+#include "search/cluster-graph.h"
+#include "search/terrain-cache.h"
+
+using Rally::Arena;
+using Rally::ClusterGraph;
+using Rally::LocalSearch;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+using Rally::TerrainCache;
+
+TEST(ClusterGraph, Paths) {
+  Random random(12);
+  Arena arena;
+  TerrainCache cache;
+  ClusterGraph graph(8);
+  LocalSearch exact;
+  std::vector<Point> changed;
+
+  uint totalCost = 0;
+  uint totalCheapest = 0;
+  RallyMap map(2, 2, random);
+
+  for(uint race = 0; race < 60; ++race) {
+    // The same terrain is raced a few times in a row with new end points.
+    if(race % 4 == 0) {
+      map = RallyMap(2 + race % 37, 2 + race * 7 % 41, random);
+    } else {
+      map.randomizeEndPoints(random);
+    }
+
+    MapInterface api(map, arena);
+    changed.clear();
+    if(cache.update(&api, changed)) {
+      graph.build(cache);
+    } else {
+      graph.repair(cache, changed);
+    }
+
+    const auto path = graph.findPath(cache, map.getStart(), map.getFinish());
+    const auto result = map.analyzePath(path);
+    ASSERT_TRUE(result.second) << map;
+
+    // A search over the whole map finds the cheapest path.
+    exact.run(cache, map.getStart(), {0, 0},
+              {static_cast<int>(map.getWidth()),
+               static_cast<int>(map.getHeight())});
+    const uint cheapest = exact.getCost(map.getFinish());
+    EXPECT_GE(result.first, cheapest);
+
+    totalCost += result.first;
+    totalCheapest += cheapest;
+  }
+
+  // The paths are close to the cheapest overall.
+  EXPECT_LE(totalCost, totalCheapest * 11 / 10);
+}
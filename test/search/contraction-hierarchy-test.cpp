@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "map/map-interface.h"
+#include "search/arena.h"
+#include "search/cluster-graph.h"
+#include "search/contraction-hierarchy.h"
+#include "search/terrain-cache.h"
+
+using Rally::Arena;
+using Rally::ContractionHierarchy;
+using Rally::HierarchyQuery;
+using Rally::LocalSearch;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+using Rally::TerrainCache;
+
+TEST(ContractionHierarchy, CheapestPaths) {
+  Random random(31);
+  Arena arena;
+  TerrainCache cache;
+  ContractionHierarchy hierarchy;
+  HierarchyQuery query;
+  LocalSearch exact;
+  std::vector<Point> changed;
+
+  RallyMap map(2, 2, random);
+  for(uint race = 0; race < 80; ++race) {
+    // The same terrain is raced a few times in a row with new end points, so
+    // hexes that were end points get learned after the hierarchy was built.
+    if(race % 5 == 0) {
+      map = RallyMap(2 + race % 29, 2 + race * 7 % 31, random);
+    } else {
+      map.randomizeEndPoints(random);
+    }
+
+    MapInterface api(map, arena);
+    changed.clear();
+    if(cache.update(&api, changed)) {
+      hierarchy.build(cache);
+    } else {
+      hierarchy.update(cache, changed);
+    }
+
+    const auto path =
+        query.findPath(hierarchy, map.getStart(), map.getFinish());
+    const auto result = map.analyzePath(path);
+    ASSERT_TRUE(result.second) << map;
+
+    exact.run(cache, map.getStart(), {0, 0},
+              {static_cast<int>(map.getWidth()),
+               static_cast<int>(map.getHeight())});
+    EXPECT_EQ(result.first, exact.getCost(map.getFinish())) << map;
+  }
+}
+
+TEST(ContractionHierarchy, WriteAndRead) {
+  Random random(8);
+  Arena arena;
+  RallyMap map(23, 17, random);
+  MapInterface api(map, arena);
+
+  TerrainCache cache;
+  std::vector<Point> changed;
+  cache.update(&api, changed);
+
+  ContractionHierarchy built;
+  built.build(cache);
+
+  std::stringstream stream;
+  built.write(stream);
+
+  ContractionHierarchy loaded;
+  loaded.read(stream);
+  EXPECT_EQ(loaded.getWidth(), 23);
+  EXPECT_EQ(loaded.getHeight(), 17);
+  EXPECT_EQ(loaded.getNumEdges(), built.getNumEdges());
+
+  HierarchyQuery query;
+  const auto expected = query.findPath(built, map.getStart(), map.getFinish());
+  EXPECT_EQ(query.findPath(loaded, map.getStart(), map.getFinish()), expected);
+
+  // The hierarchy holds everything a query needs, so the map isn't needed.
+  const Point end = {22, 16};
+  const auto path = query.findPath(loaded, {0, 0}, end);
+  Rally::Point pos = {0, 0};
+  for(const auto dir : path) {
+    pos = map.getDestination(pos, dir);
+  }
+  EXPECT_EQ(pos, end);
+
+  // Anything cut short or changed is refused.
+  const std::string bytes = stream.str();
+  std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+  EXPECT_THROW(loaded.read(truncated), std::invalid_argument);
+
+  std::string corrupt = bytes;
+  corrupt[24] = 0x7f;
+  std::stringstream corrupted(corrupt);
+  EXPECT_THROW(loaded.read(corrupted), std::invalid_argument);
+
+  std::stringstream empty;
+  EXPECT_THROW(loaded.read(empty), std::invalid_argument);
+}
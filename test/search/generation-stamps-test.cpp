@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+
+#include "search/generation-stamps.h"
+
+using Rally::GenerationStamps;
+
+TEST(GenerationStamps, MarkAndReset) {
+  GenerationStamps stamps;
+  stamps.reset(4);
+
+  EXPECT_FALSE(stamps.isMarked(0));
+  stamps.mark(3);
+  EXPECT_TRUE(stamps.isMarked(3));
+  EXPECT_FALSE(stamps.isMarked(2));
+
+  // Resetting unmarks every slot.
+  stamps.reset(4);
+  EXPECT_FALSE(stamps.isMarked(3));
+}
+
+TEST(GenerationStamps, Grow) {
+  GenerationStamps stamps;
+  stamps.reset(2);
+  stamps.mark(1);
+
+  // Growing unmarks the old slots too, and the new ones start unmarked.
+  stamps.reset(6);
+  for(size_t i = 0; i < 6; ++i) {
+    EXPECT_FALSE(stamps.isMarked(i)) << i;
+  }
+
+  stamps.mark(5);
+  EXPECT_TRUE(stamps.isMarked(5));
+}
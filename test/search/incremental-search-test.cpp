@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "map/map-interface.h"
+#include "search/arena.h"
+#include "search/cluster-graph.h"
+#include "search/incremental-search.h"
+#include "search/terrain-cache.h"
+
+using Rally::Arena;
+using Rally::IncrementalSearch;
+using Rally::LocalSearch;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+using Rally::TerrainCache;
+
+namespace {
+
+// The cost of the cheapest path in the race, from a search over the whole map.
+uint cheapestCost(const RallyMap& map) {
+  Arena arena;
+  MapInterface api(map, arena);
+  TerrainCache terrain;
+  std::vector<Point> changed;
+  terrain.update(&api, changed);
+
+  LocalSearch exact;
+  exact.run(terrain, map.getStart(), {0, 0},
+            {static_cast<int>(map.getWidth()),
+             static_cast<int>(map.getHeight())});
+  return exact.getCost(map.getFinish());
+}
+
+}  // namespace
+
+TEST(IncrementalSearch, Repairs) {
+  Random random(17);
+  RallyMap map(40, 30, random);
+  Arena arena;
+  TerrainCache terrain;
+  std::vector<Point> changed;
+
+  MapInterface api(map, arena);
+  terrain.update(&api, changed);
+
+  IncrementalSearch search;
+  search.reset(terrain, map.getStart(), map.getFinish());
+
+  auto result = map.analyzePath(search.findPath());
+  ASSERT_TRUE(result.second) << map;
+  EXPECT_EQ(result.first, cheapestCost(map));
+  const uint fullExpansions = search.getExpansions();
+
+  uint repairExpansions = 0;
+  for(uint round = 0; round < 40; ++round) {
+    // A few hexes are edited, and every so often the start moves.
+    for(uint edit = 0; edit < 3; ++edit) {
+      const Point pos = {static_cast<int>(random.below(map.getWidth())),
+                         static_cast<int>(random.below(map.getHeight()))};
+      map.setRoughness(pos, 0, random);
+      search.setRoughness(pos, map.getRoughness(pos));
+    }
+
+    if(round % 4 == 0) {
+      Point start;
+      do {
+        start = {static_cast<int>(random.below(map.getWidth())),
+                 static_cast<int>(random.below(map.getHeight()))};
+      } while(start == map.getFinish());
+
+      // The old start counts with its real roughness again.
+      const Point oldStart = map.getStart();
+      map.setEndPoints(start, map.getFinish());
+      search.setStart(start);
+      search.setRoughness(oldStart, map.getRoughness(oldStart));
+    }
+
+    result = map.analyzePath(search.findPath());
+    ASSERT_TRUE(result.second) << map;
+    EXPECT_EQ(result.first, cheapestCost(map)) << round;
+    repairExpansions += search.getExpansions();
+  }
+
+  // Repairs only look at the part of the search the edits affect.
+  EXPECT_LT(repairExpansions / 40, fullExpansions / 2);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "map/map-interface.h"
+#include "search/arena.h"
+#include "search/cluster-graph.h"
+#include "search/landmarks.h"
+#include "search/terrain-cache.h"
+
+using Rally::Arena;
+using Rally::LandmarkBound;
+using Rally::Landmarks;
+using Rally::LocalSearch;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+using Rally::TerrainCache;
+
+TEST(Landmarks, LowerBound) {
+  Random random(31);
+  Arena arena;
+  TerrainCache cache;
+  Landmarks landmarks(4);
+  LocalSearch exact;
+  std::vector<Point> changed;
+
+  uint64_t totalBound = 0;
+  uint64_t totalGeometric = 0;
+  RallyMap map(2, 2, random);
+
+  for(uint race = 0; race < 60; ++race) {
+    // The same terrain is raced a few times in a row with new end points.
+    if(race % 4 == 0) {
+      map = RallyMap(2 + race % 29, 2 + race * 7 % 31, random);
+    } else {
+      map.randomizeEndPoints(random);
+    }
+
+    MapInterface api(map, arena);
+    changed.clear();
+    if(cache.update(&api, changed)) {
+      landmarks.build(cache);
+    }
+
+    const Point finish = map.getFinish();
+    const LandmarkBound bound(landmarks, finish, map.getStart(), finish);
+    EXPECT_EQ(bound(finish), 0);
+
+    const int width = static_cast<int>(map.getWidth());
+    const int height = static_cast<int>(map.getHeight());
+    exact.run(cache, finish, {0, 0}, {width, height});
+
+    for(int y = 0; y < height; ++y) {
+      for(int x = 0; x < width; ++x) {
+        const Point pos = {x, y};
+        ASSERT_LE(bound(pos), exact.getCost(pos)) << map;
+
+        totalBound += bound(pos);
+        totalGeometric += pos.distanceTo(finish) * 2;
+      }
+    }
+  }
+
+  // On rough terrain the landmarks know far more than the distance does.
+  EXPECT_GT(totalBound, totalGeometric * 3 / 2);
+}
+
+TEST(Landmarks, SpreadOut) {
+  Random random(7);
+  Arena arena;
+  RallyMap map(30, 20, random);
+  MapInterface api(map, arena);
+  TerrainCache cache;
+  std::vector<Point> changed;
+  cache.update(&api, changed);
+
+  Landmarks landmarks(6);
+  landmarks.build(cache);
+
+  const auto& picked = landmarks.getLandmarks();
+  ASSERT_EQ(picked.size(), 6);
+
+  for(size_t i = 0; i < picked.size(); ++i) {
+    // The cost from a landmark to itself is zero.
+    EXPECT_EQ(landmarks.getCosts(picked[i])[i], 0);
+
+    for(size_t j = 0; j < i; ++j) {
+      EXPECT_NE(picked[i], picked[j]);
+    }
+  }
+
+  // Small maps get a landmark on every hex at most.
+  RallyMap tiny(2, 2, random);
+  MapInterface tinyApi(tiny, arena);
+  cache.update(&tinyApi, changed);
+  landmarks.build(cache);
+  EXPECT_EQ(landmarks.getLandmarks().size(), 4);
+}
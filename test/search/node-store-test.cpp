@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include "search/node-store.h"
+
+using Rally::NodeStore;
+using Rally::Point;
+
+TEST(NodeStore, InsertAndFind) {
+  NodeStore<uint> store;
+  store.reset(4, 3);
+
+  EXPECT_FALSE(store.contains({0, 0}));
+  EXPECT_EQ(store.find({3, 2}), nullptr);
+  EXPECT_ANY_THROW(store.at({3, 2}));
+
+  store.insert({3, 2}, 7);
+  store.insert({0, 1}, 5);
+
+  EXPECT_TRUE(store.contains({3, 2}));
+  EXPECT_FALSE(store.contains({2, 1}));
+  EXPECT_EQ(store.at({3, 2}), 7);
+  ASSERT_NE(store.find({0, 1}), nullptr);
+  EXPECT_EQ(*store.find({0, 1}), 5);
+
+  store.at({3, 2}) = 9;
+  EXPECT_EQ(store.at({3, 2}), 9);
+}
+
+TEST(NodeStore, Reset) {
+  NodeStore<uint> store;
+  store.reset(4, 3);
+  store.insert({3, 2}, 7);
+
+  // Resetting forgets every point.
+  store.reset(4, 3);
+  EXPECT_FALSE(store.contains({3, 2}));
+
+  // Maps of a different shape reuse the same memory.
+  store.insert({1, 1}, 1);
+  store.reset(2, 6);
+  EXPECT_FALSE(store.contains({1, 1}));
+  store.insert({1, 5}, 3);
+  EXPECT_EQ(store.at({1, 5}), 3);
+
+  // Larger maps grow the store.
+  store.reset(50, 50);
+  EXPECT_FALSE(store.contains({1, 5}));
+  store.insert({49, 49}, 4);
+  EXPECT_EQ(store.at({49, 49}), 4);
+}
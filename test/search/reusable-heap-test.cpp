@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+
+#include "search/reusable-heap.h"
+
+using Rally::ReusableHeap;
+
+TEST(ReusableHeap, Clear) {
+  ReusableHeap<int> heap;
+
+  for(int i = 100; i > 0; --i) {
+    heap.push(i);
+  }
+
+  EXPECT_EQ(heap.top(), 1);
+  const size_t capacity = heap.capacity();
+
+  heap.clear();
+  EXPECT_TRUE(heap.empty());
+  EXPECT_EQ(heap.capacity(), capacity);
+
+  heap.push(7);
+  heap.push(3);
+  EXPECT_EQ(heap.top(), 3);
+  heap.pop();
+  EXPECT_EQ(heap.top(), 7);
+}
@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include "search/search-state.h"
+
+using Rally::Point;
+using Rally::SearchState;
+
+TEST(SearchState, ReachAndClose) {
+  SearchState state;
+  state.reset(4, 3);
+
+  const size_t a = state.index({1, 1});
+  const size_t b = state.index({2, 1});
+  EXPECT_FALSE(state.isReached(a));
+
+  state.reach(a, 10, 3, Direction::T::eNorthEast);
+  state.reach(b, 12, 9, Direction::T::eSouthWest);
+
+  // Neighboring directions share a byte, so they must not clobber each other.
+  EXPECT_TRUE(state.isReached(a));
+  EXPECT_EQ(state.getCost(a), 10);
+  EXPECT_EQ(state.getRoughness(a), 3);
+  EXPECT_EQ(state.getParentDir(a), Direction::T::eNorthEast);
+  EXPECT_EQ(state.getParentDir(b), Direction::T::eSouthWest);
+
+  EXPECT_FALSE(state.isClosed(a));
+  state.close(a);
+  EXPECT_TRUE(state.isClosed(a));
+  EXPECT_FALSE(state.isClosed(b));
+
+  // Closed bits are cleared lazily when a point is reached again.
+  state.reset(4, 3);
+  EXPECT_FALSE(state.isReached(a));
+  state.reach(a, 1, 1, Direction::T::eNone);
+  EXPECT_FALSE(state.isClosed(a));
+}
+
+TEST(SearchState, TracePath) {
+  SearchState state;
+  state.reset(5, 5);
+
+  const Point start = {2, 2};
+  state.reach(state.index(start), 0, 1, Direction::T::eNone);
+  state.reach(state.index({3, 1}), 2, 1, Direction::T::eNorth);
+  state.reach(state.index({3, 2}), 4, 1, Direction::T::eSouthEast);
+
+  const std::vector<Direction::T> path = state.tracePath({3, 2});
+  ASSERT_EQ(path.size(), 2);
+  EXPECT_EQ(path[0], Direction::T::eNorth);
+  EXPECT_EQ(path[1], Direction::T::eSouthEast);
+
+  EXPECT_TRUE(state.tracePath(start).empty());
+}
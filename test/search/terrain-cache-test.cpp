@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "map/map-interface.h"
+#include "search/arena.h"
+#include "search/terrain-cache.h"
+
+using Rally::Arena;
+using Rally::MapInterface;
+using Rally::Point;
+using Rally::RallyMap;
+using Rally::Random;
+using Rally::TerrainCache;
+
+namespace {
+
+// Every hex other than the end points is known.
+void expectLearned(const TerrainCache& cache, const RallyMap& map) {
+  for(int y = 0; y < static_cast<int>(map.getHeight()); ++y) {
+    for(int x = 0; x < static_cast<int>(map.getWidth()); ++x) {
+      const Point pos = {x, y};
+      const uint expected = pos == map.getStart() || pos == map.getFinish()
+                                ? 1
+                                : map.getRoughness(pos);
+      EXPECT_EQ(cache.getRoughness(pos), expected) << x << ", " << y;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(TerrainCache, Learn) {
+  Random random(8);
+  const RallyMap map(13, 9, random);
+  Arena arena;
+  TerrainCache cache;
+  std::vector<Point> changed;
+
+  MapInterface api(map, arena);
+  EXPECT_TRUE(cache.update(&api, changed));
+  EXPECT_EQ(api.getMapLooks(), 13 * 9);
+  EXPECT_TRUE(changed.empty());
+  expectLearned(cache, map);
+}
+
+TEST(TerrainCache, SameTerrain) {
+  Random random(9);
+  RallyMap map(11, 7, random);
+  Arena arena;
+  TerrainCache cache;
+  std::vector<Point> changed;
+
+  {
+    MapInterface api(map, arena);
+    cache.update(&api, changed);
+  }
+
+  // Only the old end points are looked at again.
+  const Point oldStart = map.getStart();
+  const Point oldFinish = map.getFinish();
+  map.setEndPoints({0, 0}, {10, 6});
+  if(oldStart == Point({0, 0}) || oldFinish == Point({10, 6})) {
+    map.setEndPoints({1, 0}, {9, 6});
+  }
+
+  MapInterface api(map, arena);
+  EXPECT_FALSE(cache.update(&api, changed));
+  EXPECT_LE(api.getMapLooks(), 2);
+  expectLearned(cache, map);
+
+  for(const Point& pos : changed) {
+    EXPECT_TRUE(pos == oldStart || pos == oldFinish);
+    EXPECT_NE(map.getRoughness(pos), 1);
+  }
+
+  // Changing the terrain means learning all of it again.
+  map.setRoughness({5, 5}, 0, random);
+  MapInterface changedApi(map, arena);
+  EXPECT_TRUE(cache.update(&changedApi, changed));
+  expectLearned(cache, map);
+}
+
+TEST(TerrainCache, FollowEdits) {
+  Random random(10);
+  RallyMap map(12, 10, random);
+  Arena arena;
+  TerrainCache cache(true);
+  std::vector<Point> changed;
+
+  {
+    MapInterface api(map, arena);
+    cache.update(&api, changed);
+  }
+
+  // A patch of edits is learned from its edges in.
+  const Point start = map.getStart();
+  std::vector<Point> edited = {{5, 5}, {5, 4}, {6, 4}, {4, 5}, {6, 5}, {4, 6},
+                               {5, 6}, {2, 7}, start};
+  for(const Point& pos : edited) {
+    map.setRoughness(pos, 0, random);
+  }
+
+  changed.clear();
+  MapInterface api(map, arena);
+  EXPECT_FALSE(cache.update(&api, changed));
+  EXPECT_LE(api.getMapLooks(), edited.size() + 2);
+  expectLearned(cache, map);
+
+  for(const Point& pos : changed) {
+    EXPECT_TRUE(std::find(edited.begin(), edited.end(), pos) != edited.end() ||
+                pos == map.getFinish());
+  }
+
+  // The start was edited while it was the start, so its roughness is learned
+  // once it isn't any more.
+  map.setEndPoints({0, 0}, {11, 9});
+  if(start == Point({0, 0})) {
+    map.setEndPoints({1, 0}, {11, 9});
+  }
+
+  MapInterface nextApi(map, arena);
+  EXPECT_FALSE(cache.update(&nextApi, changed));
+  expectLearned(cache, map);
+
+  // Setting the roughness of the whole map can't be followed.
+  map.randomizeRoughness(random);
+  MapInterface randomApi(map, arena);
+  EXPECT_TRUE(cache.update(&randomApi, changed));
+  expectLearned(cache, map);
+}
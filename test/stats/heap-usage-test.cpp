@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <new>
+
+#include "stats/heap-usage.h"
+
+using Rally::HeapScope;
+using Rally::liveHeapBytes;
+
+// The allocation functions are called directly, since the compiler is allowed
+// to optimize away a matched `new` and `delete`.
+TEST(HeapUsage, LiveBytes) {
+  const int64_t before = liveHeapBytes();
+
+  void* const block = ::operator new(1000);
+  const int64_t during = liveHeapBytes();
+  ::operator delete(block);
+  const int64_t after = liveHeapBytes();
+
+  EXPECT_EQ(during - before, 1000);
+  EXPECT_EQ(after, before);
+}
+
+TEST(HeapUsage, Peak) {
+  HeapScope outer;
+  const int64_t start = outer.peakBytes();
+
+  ::operator delete(::operator new(5000));
+
+  int64_t innerPeak;
+  {
+    HeapScope inner;
+    void* const block = ::operator new(100);
+    innerPeak = inner.peakBytes();
+    ::operator delete(block);
+  }
+
+  // Memory that was freed still counts towards the peak, and an inner scope
+  // doesn't hide what happened before it.
+  const int64_t outerPeak = outer.peakBytes();
+
+  // Memory that was live before the scope opened doesn't count.
+  void* const held = ::operator new(3000);
+  int64_t heldPeak;
+  {
+    HeapScope after;
+    heldPeak = after.peakBytes();
+  }
+  ::operator delete(held);
+
+  EXPECT_EQ(start, 0);
+  EXPECT_EQ(innerPeak, 100);
+  EXPECT_EQ(outerPeak, 5000);
+  EXPECT_EQ(heldPeak, 0);
+}
+
+TEST(HeapUsage, Allocations) {
+  uint64_t count;
+  uint64_t bytes;
+  uint64_t innerCount;
+  {
+    HeapScope scope;
+    ::operator delete(::operator new(300));
+    void* const block = ::operator new[](200);
+    {
+      HeapScope inner;
+      ::operator delete(::operator new(1, std::nothrow));
+      innerCount = inner.allocations();
+    }
+    ::operator delete[](block);
+
+    count = scope.allocations();
+    bytes = scope.allocatedBytes();
+  }
+
+  // Frees don't take anything off.
+  EXPECT_EQ(innerCount, 1);
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(bytes, 501);
+}
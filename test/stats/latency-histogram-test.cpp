@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include "stats/latency-histogram.h"
+
+using Rally::LatencyHistogram;
+
+TEST(LatencyHistogram, Percentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.percentile(0.5), 0);
+
+  for(uint64_t value = 1; value <= 1000; ++value) {
+    histogram.record(value * 1000);
+  }
+
+  EXPECT_EQ(histogram.getCount(), 1000);
+  EXPECT_EQ(histogram.getMax(), 1000000);
+  EXPECT_EQ(histogram.getTotal(), 500500000);
+
+  // Estimates are never below the true value and never off by more than 1
+  // part in the number of sub buckets.
+  const double tolerance = 1.0 / LatencyHistogram::kSubBuckets;
+  for(const auto& expected : {std::make_pair(0.5, 500000.0),
+                              std::make_pair(0.9, 900000.0),
+                              std::make_pair(0.99, 990000.0)}) {
+    const double estimate = histogram.percentile(expected.first);
+    EXPECT_GE(estimate, expected.second);
+    EXPECT_LE(estimate, expected.second * (1 + tolerance));
+  }
+
+  EXPECT_EQ(histogram.percentile(1), 1000000);
+
+  // Small values are exact.
+  LatencyHistogram small;
+  small.record(3);
+  small.record(5);
+  EXPECT_EQ(small.percentile(0.5), 3);
+  EXPECT_EQ(small.percentile(1), 5);
+}
+
+TEST(LatencyHistogram, Merge) {
+  LatencyHistogram all;
+  LatencyHistogram even;
+  LatencyHistogram odd;
+
+  for(uint64_t value = 0; value < 5000; ++value) {
+    all.record(value * 37);
+    (value % 2 == 0 ? even : odd).record(value * 37);
+  }
+
+  even.merge(odd);
+
+  EXPECT_EQ(even.getCount(), all.getCount());
+  EXPECT_EQ(even.getTotal(), all.getTotal());
+  EXPECT_EQ(even.getMax(), all.getMax());
+  for(const double fraction : {0.1, 0.5, 0.9, 0.99, 0.999}) {
+    EXPECT_EQ(even.percentile(fraction), all.percentile(fraction));
+  }
+
+  even.clear();
+  EXPECT_EQ(even.getCount(), 0);
+  EXPECT_EQ(even.getMax(), 0);
+}